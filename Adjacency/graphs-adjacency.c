@@ -2,150 +2,88 @@
  * @file graphs-adjacency.c
  * @author Jorge Ricarte (jorgericartepg@gmail.com)
  * @brief A program for creating and printing the adjacency list representation of a graph.
- * @version 0.1
+ * @version 0.2
  * @date 2023-10-16
  * @copyright Copyright (c) 2023
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-typedef struct AdjListNode
-{
-	int dest;
-	struct AdjListNode *next;
-} AdjListNode;
-
-typedef struct AdjList
-{
-	AdjListNode *head;
-} AdjList;
-
-typedef struct Graph
-{
-	int V;
-	char *labels;
-	AdjList *array;
-} Graph;
-
-AdjListNode *newAdjListNode(int dest)
-{
-	AdjListNode *newNode = (AdjListNode *)malloc(sizeof(AdjListNode));
-	newNode->dest = dest;
-	newNode->next = NULL;
-	return newNode;
-}
-
-void addEdge(Graph *graph, int src, int dest)
-{
-	AdjListNode *newNode = newAdjListNode(dest);
-	newNode->next = graph->array[src].head;
-	graph->array[src].head = newNode;
-}
+#include "../Common/loader.h"
 
-Graph *createGraph(char *fileName)
+// Function to time the tokenizer alone and then a full load, reporting both in MB/s
+void benchmarkParse(char *fileName)
 {
-	// Open the input file
-	FILE *file = fopen(fileName, "r");
-	if (file == NULL)
+	Scanner scanner;
+	double start = nowSeconds();
+	openScanner(&scanner, fileName);
+	int64_t tokens = 0, checksum = 0;
+	while (!atEnd(&scanner))
 	{
-		printf("Erro ao abrir o arquivo.\n");
-		exit(1);
-	}
-
-	// Read the first line to determine the number of vertices
-	char line[100];
-	fgets(line, sizeof(line), file);
-
-	int V = 0;
-	for (int i = 0; line[i] != '\0'; ++i)
-	{
-		if (line[i] != ' ' && line[i] != '\n' && line[i] != '\r')
+		int64_t value;
+		if (scanInt64(&scanner, &value, true))
 		{
-			++V;
+			++tokens;
+			checksum += value;
 		}
-	}
-
-	char vertexLabels[V];
-	for (int i = 0, j = 0; line[i] != '\0'; ++i)
-	{
-		if (line[i] != ' ' && line[i] != '\n' && line[i] != '\r')
+		else if (!atEnd(&scanner))
 		{
-			vertexLabels[j] = line[i];
-			++j;
+			++scanner.cur; // Labels and other non-numeric bytes
 		}
 	}
-
-	// Allocate memory for the graph structure
-	Graph *graph = (Graph *)malloc(sizeof(Graph));
-	graph->V = V;
-	graph->labels = (char *)malloc(V * sizeof(char));
-	// ... Initializing adjacency lists ...
-	for (int i = 0; i < V; ++i)
-	{
-		graph->labels[i] = vertexLabels[i];
-	}
-
-	graph->array = (AdjList *)malloc(V * sizeof(AdjList));
-	for (int i = 0; i < V; ++i)
-	{
-		graph->array[i].head = NULL;
-	}
-
-	for (int i = 0; i < V; ++i)
-	{
-		for (int j = 0; j < V; ++j)
-		{
-			int weight;
-			fscanf(file, "%d", &weight);
-
-			// If the weight is 1, add an edge between vertices i and j
-			if (weight == 1)
-			{
-				addEdge(graph, i, j);
-			}
-		}
-	}
-
-	fclose(file);
-	return graph;
+	double megabytes = scanner.size / 1e6;
+	closeScanner(&scanner);
+	double tokenizeTime = nowSeconds() - start;
+
+	start = nowSeconds();
+	Graph *graph = createGraph(fileName);
+	double loadTime = nowSeconds() - start;
+
+	printf("File: %s (%.1f MB)\n", fileName, megabytes);
+	printf("Tokenize: %lld integers (checksum %lld) in %.3f s, %.1f MB/s\n",
+		   (long long)tokens, (long long)checksum, tokenizeTime, megabytes / tokenizeTime);
+	printf("Load: %d vertices, %lld edges in %.3f s, %.1f MB/s\n",
+		   graph->V, (long long)graph->E, loadTime, megabytes / loadTime);
+	freeGraph(graph);
 }
 
-// Function to print the adjacency list representation of the graph
-void printGraph(Graph *graph)
+int main(int argc, char *argv[])
 {
-	for (int v = 0; v < graph->V; ++v)
+	char *file = NULL;
+	bool parseOnly = false;
+	bool valid = true;
+	for (int i = 1; i < argc; i++)
 	{
-		printf("Adjacencies of vertex %c: ", graph->labels[v]);
-		AdjListNode *current = graph->array[v].head;
-		while (current != NULL)
-		{
-			printf("%c -> ", graph->labels[current->dest]);
-			current = current->next;
-		}
-		printf("NULL\n");
+		if (strcmp(argv[i], "--parse-only") == 0)
+			parseOnly = true;
+		else if (outputOption(argv[i]))
+			continue;
+		else if (statsOption(argv[i], argv[0]))
+			continue;
+		else if (file == NULL)
+			file = argv[i];
+		else
+			valid = false;
 	}
-}
-
-int main(int argc, char *argv[])
-{
-	if (argc != 2)
+	if (file == NULL || !valid)
 	{
-		printf("Usage: %s <file1>\n", argv[0]);
+		printf("Usage: %s [--parse-only] [--output=text|csv|binary] [--stats[=FILE]] <file1>\n", argv[0]);
 		return 1;
 	}
+	if (parseOnly)
+	{
+		benchmarkParse(file);
+		return 0;
+	}
 
-	char *file = argv[1];
 	Graph *graph = createGraph(file);
 
-	printf("Graph:\n");
-	printf("Vertex labels: %s\n", graph->labels);
-
-	printGraph(graph);
+	statPhase(PHASE_OUTPUT);
+	printAdjacency(graph, false);
 
 	// Free memory
-	free(graph->labels);
-	free(graph->array);
-	free(graph);
+	freeGraph(graph);
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,281 @@
+/**
+ * @file graph-bench.c
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief A program to time every tool on generated graphs of growing size.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * For every family and size the graph is generated with generate.h and written as a DIMACS
+ * file (plus a renamed copy for the isomorphism check), then each tool is run on it as its
+ * own process with its output discarded. The wall time, the CPU time and the peak resident
+ * memory of the process (from wait4) are printed as one JSON object per line, or as CSV,
+ * tagged with --label so the results of two commits can be joined and compared.
+ */
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Common/generate.h"
+
+#define BENCH_MAX_LIST 32
+
+typedef struct Tool {
+    const char *name;
+    const char *program;
+} Tool;
+
+static const Tool tools[] = {
+    {"adjacency", "graphs-adjacency"},
+    {"flooding", "flooding"},
+    {"dijkstra", "dijkstra"},
+    {"prim", "prim"},
+    {"isomorphism", "areIso"},
+};
+
+typedef struct RunResult {
+    char status[32];           // "ok", "exit N", "signal N", "timeout" or "missing"
+    double seconds;
+    double user;
+    double sys;
+    long maxRssKb;
+} RunResult;
+
+typedef struct BenchOptions {
+    const char *toolDir;
+    const char *workDir;
+    const char *label;
+    const char *families[BENCH_MAX_LIST];
+    int familyCount;
+    int64_t sizes[BENCH_MAX_LIST];
+    int sizeCount;
+    int degree;
+    int runs;
+    uint64_t seed;
+    double timeout;
+    bool csv;
+} BenchOptions;
+
+void printUsage(const char *program) {
+    printf("Usage: %s [--tools=DIR] [--families=er,rmat,grid,regular] [--sizes=1000,10000,100000]\n", program);
+    printf("       [--degree=8] [--runs=3] [--seed=1] [--timeout=60] [--work=DIR] [--label=TEXT] [--csv]\n");
+    printf("--tools is the directory holding the built tools, --label tags every record (a commit id, say).\n");
+}
+
+// Function to split a comma-separated list in place; returns the number of items
+int splitList(char *text, const char **items) {
+    int count = 0;
+    for (char *item = strtok(text, ","); item != NULL && count < BENCH_MAX_LIST; item = strtok(NULL, ",")) {
+        items[count++] = item;
+    }
+    return count;
+}
+
+// Function to run a program with its output discarded, killing it after timeout seconds
+void runTool(const char *path, char *const args[], double timeout, RunResult *result) {
+    memset(result, 0, sizeof(RunResult));
+    if (access(path, X_OK) != 0) {
+        strcpy(result->status, "missing");
+        return;
+    }
+    // SIGCHLD stays blocked so sigtimedwait can wait for the child with a deadline
+    sigset_t childExit;
+    sigemptyset(&childExit);
+    sigaddset(&childExit, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &childExit, NULL);
+    fflush(stdout); // Otherwise the child would write out whatever is still buffered
+    double start = nowSeconds();
+    pid_t pid = fork();
+    if (pid < 0) {
+        printf("fork failed: %s\n", strerror(errno));
+        exit(1);
+    }
+    if (pid == 0) {
+        sigprocmask(SIG_UNBLOCK, &childExit, NULL);
+        FILE *null = freopen("/dev/null", "w", stdout);
+        (void)null;
+        dup2(STDOUT_FILENO, STDERR_FILENO);
+        execv(path, args);
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    bool timedOut = false;
+    while (wait4(pid, &status, WNOHANG, &usage) == 0) {
+        double left = timeout - (nowSeconds() - start);
+        struct timespec wait = {(time_t)left, (long)((left - (time_t)left) * 1e9)};
+        if (left <= 0 || (sigtimedwait(&childExit, NULL, &wait) < 0 && errno == EAGAIN)) {
+            kill(pid, SIGKILL);
+            wait4(pid, &status, 0, &usage);
+            timedOut = true;
+            break;
+        }
+    }
+    result->seconds = nowSeconds() - start;
+    result->user = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6;
+    result->sys = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    result->maxRssKb = usage.ru_maxrss;
+    if (timedOut) {
+        strcpy(result->status, "timeout");
+    } else if (WIFSIGNALED(status)) {
+        snprintf(result->status, sizeof(result->status), "signal %d", WTERMSIG(status));
+    } else if (WEXITSTATUS(status) != 0) {
+        snprintf(result->status, sizeof(result->status), "exit %d", WEXITSTATUS(status));
+    } else {
+        strcpy(result->status, "ok");
+    }
+}
+
+// Function to pick the two size parameters of a family for roughly 'size' vertices
+bool familySize(const char *family, int64_t size, int degree, int64_t *first, int64_t *second) {
+    if (strcmp(family, "er") == 0) {
+        *first = size;
+        *second = size * degree / 2;
+    } else if (strcmp(family, "rmat") == 0) {
+        int scale = 1;
+        while (((int64_t)2 << scale) <= size + size / 2) {
+            scale++;
+        }
+        *first = scale;
+        *second = degree / 2 > 0 ? degree / 2 : 1;
+    } else if (strcmp(family, "grid") == 0) {
+        int64_t side = 1;
+        while ((side + 1) * (side + 1) <= size) {
+            side++;
+        }
+        *first = *second = side;
+    } else if (strcmp(family, "regular") == 0) {
+        *first = size + (size * degree % 2);
+        *second = degree;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void printRecord(const BenchOptions *options, const char *tool, const char *family, int64_t size,
+                 const Graph *graph, int run, const RunResult *result) {
+    if (options->csv) {
+        printf("%s,%s,%s,%lld,%d,%lld,%d,%s,%.6f,%.6f,%.6f,%ld\n", options->label, tool, family, (long long)size,
+               graph->V, (long long)graph->E, run, result->status, result->seconds, result->user, result->sys,
+               result->maxRssKb);
+    } else {
+        printf("{\"label\": \"%s\", \"tool\": \"%s\", \"family\": \"%s\", \"size\": %lld, \"vertices\": %d, "
+               "\"edges\": %lld, \"run\": %d, \"status\": \"%s\", \"seconds\": %.6f, \"user\": %.6f, "
+               "\"sys\": %.6f, \"maxrss_kb\": %ld}\n",
+               options->label, tool, family, (long long)size, graph->V, (long long)graph->E, run, result->status,
+               result->seconds, result->user, result->sys, result->maxRssKb);
+    }
+    fflush(stdout);
+}
+
+// Function to generate one graph and run every tool on it
+void benchGraph(const BenchOptions *options, const char *family, int64_t size) {
+    int64_t first, second;
+    if (!familySize(family, size, options->degree, &first, &second)) {
+        printf("Unknown family %s.\n", family);
+        exit(1);
+    }
+    Graph *graph = generateGraph(family, first, second, 100, options->seed);
+    Graph *renamed = permuteGraph(graph, options->seed + 1);
+    char file[4096], copy[4096], comment[128];
+    snprintf(file, sizeof(file), "%s/bench-%s-%lld-%llu.gr", options->workDir, family, (long long)size,
+             (unsigned long long)options->seed);
+    snprintf(copy, sizeof(copy), "%s/bench-%s-%lld-%llu-renamed.gr", options->workDir, family, (long long)size,
+             (unsigned long long)options->seed);
+    snprintf(comment, sizeof(comment), "%s %lld %lld seed %llu", family, (long long)first, (long long)second,
+             (unsigned long long)options->seed);
+    writeTextGraph(graph, file, comment);
+    writeTextGraph(renamed, copy, comment);
+    freeGraph(renamed);
+
+    for (size_t t = 0; t < sizeof(tools) / sizeof(tools[0]); ++t) {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", options->toolDir, tools[t].program);
+        char *args[4] = {path, file, NULL, NULL};
+        if (strcmp(tools[t].name, "flooding") == 0) {
+            args[2] = file;
+        } else if (strcmp(tools[t].name, "dijkstra") == 0) {
+            args[2] = "0";
+        } else if (strcmp(tools[t].name, "isomorphism") == 0) {
+            args[2] = copy;
+        }
+        for (int run = 0; run < options->runs; ++run) {
+            RunResult result;
+            runTool(path, args, options->timeout, &result);
+            printRecord(options, tools[t].name, family, size, graph, run, &result);
+            if (strcmp(result.status, "ok") != 0) {
+                break; // A missing, failing or timed-out tool would only do the same again
+            }
+        }
+    }
+    remove(file);
+    remove(copy);
+    freeGraph(graph);
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    options.toolDir = ".";
+    options.workDir = "/tmp";
+    options.label = "";
+    options.degree = 8;
+    options.runs = 3;
+    options.seed = 1;
+    options.timeout = 60;
+    options.csv = false;
+    char defaultFamilies[] = "er,rmat,grid,regular";
+    options.familyCount = splitList(defaultFamilies, options.families);
+    options.sizes[0] = 1000;
+    options.sizes[1] = 10000;
+    options.sizes[2] = 100000;
+    options.sizeCount = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--tools=", 8) == 0) {
+            options.toolDir = argv[i] + 8;
+        } else if (strncmp(argv[i], "--work=", 7) == 0) {
+            options.workDir = argv[i] + 7;
+        } else if (strncmp(argv[i], "--label=", 8) == 0) {
+            options.label = argv[i] + 8;
+        } else if (strncmp(argv[i], "--families=", 11) == 0) {
+            options.familyCount = splitList(argv[i] + 11, options.families);
+        } else if (strncmp(argv[i], "--sizes=", 8) == 0) {
+            const char *items[BENCH_MAX_LIST];
+            options.sizeCount = splitList(argv[i] + 8, items);
+            for (int s = 0; s < options.sizeCount; ++s) {
+                options.sizes[s] = atoll(items[s]);
+            }
+        } else if (strncmp(argv[i], "--degree=", 9) == 0 && atoi(argv[i] + 9) > 0) {
+            options.degree = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "--runs=", 7) == 0 && atoi(argv[i] + 7) > 0) {
+            options.runs = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            options.seed = strtoull(argv[i] + 7, NULL, 10);
+        } else if (strncmp(argv[i], "--timeout=", 10) == 0 && atof(argv[i] + 10) > 0) {
+            options.timeout = atof(argv[i] + 10);
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            options.csv = true;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.csv) {
+        printf("label,tool,family,size,vertices,edges,run,status,seconds,user,sys,maxrss_kb\n");
+    }
+    for (int f = 0; f < options.familyCount; ++f) {
+        for (int s = 0; s < options.sizeCount; ++s) {
+            benchGraph(&options, options.families[f], options.sizes[s]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file arena.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Bump allocator over a list of blocks, released all at once.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * arenaAlloc hands out consecutive pieces of the current block and only maps a new one when
+ * the block is used up; a request larger than a quarter of a block gets a block of its
+ * own, so big arrays never waste the tail of a shared block. Nothing is freed piece by
+ * piece: freeArena returns every block in one call. Blocks come straight from mmap rather
+ * than malloc, whose growing mmap threshold would keep big freed blocks in the heap, so
+ * freeing a graph really gives its memory back to the system.
+ */
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#define ARENA_BLOCK_SIZE ((size_t)1 << 20)
+#define ARENA_ALIGN 64
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;               // Usable bytes after the header
+    size_t used;
+    size_t mapped;             // Bytes of the mapping, header included
+} ArenaBlock;
+
+typedef struct Arena {
+    ArenaBlock *head;          // Block being filled, then the older ones
+    int64_t blocks;            // Blocks mapped
+    size_t bytes;              // Bytes handed out
+} Arena;
+
+// Size of the block header, rounded so the first piece is aligned
+#define ARENA_HEADER (((sizeof(ArenaBlock) + ARENA_ALIGN - 1) / ARENA_ALIGN) * ARENA_ALIGN)
+
+GRAPH_API void initArena(Arena *arena) {
+    arena->head = NULL;
+    arena->blocks = 0;
+    arena->bytes = 0;
+}
+
+// Function to map zero-filled pages for at least size bytes, or abort the program
+GRAPH_API void *mapPages(size_t size) {
+    void *pages = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+    return pages;
+}
+
+// Function to map a block of at least size usable bytes
+GRAPH_API ArenaBlock *newArenaBlock(size_t size) {
+    ArenaBlock *block = (ArenaBlock *)mapPages(ARENA_HEADER + size);
+    block->size = size;
+    block->used = 0;
+    block->mapped = ARENA_HEADER + size;
+    return block;
+}
+
+// Function to allocate size bytes, aligned to ARENA_ALIGN, that live until freeArena
+GRAPH_API void *arenaAlloc(Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    if (size == 0) {
+        size = ARENA_ALIGN;
+    }
+    ArenaBlock *block = arena->head;
+    if (size > ARENA_BLOCK_SIZE / 4) {
+        // Big pieces get their own block, kept behind the one being filled
+        block = newArenaBlock(size);
+        if (arena->head != NULL) {
+            block->next = arena->head->next;
+            arena->head->next = block;
+        } else {
+            block->next = NULL;
+            arena->head = block;
+        }
+        arena->blocks++;
+    } else if (block == NULL || block->size - block->used < size) {
+        block = newArenaBlock(ARENA_BLOCK_SIZE - ARENA_HEADER);
+        block->next = arena->head;
+        arena->head = block;
+        arena->blocks++;
+    }
+    void *piece = (char *)block + ARENA_HEADER + block->used;
+    block->used += size;
+    arena->bytes += size;
+    return piece;
+}
+
+// Function to release every block of the arena; the arena can be used again afterwards
+GRAPH_API void freeArena(Arena *arena) {
+    ArenaBlock *block = arena->head;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        munmap(block, block->mapped);
+        block = next;
+    }
+    initArena(arena);
+}
+
+#endif // ARENA_H
@@ -0,0 +1,206 @@
+/**
+ * @file bfs.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Direction-optimizing breadth-first search (Beamer, Asanovic and Patterson).
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * A level is expanded top-down (every frontier vertex scans its out-edges) while the frontier
+ * is small, and bottom-up (every unreached vertex scans its in-edges until it finds a parent
+ * in the frontier) once the frontier's edges outnumber the unexplored edges divided by
+ * BFS_ALPHA. On low-diameter graphs the middle levels hold most of the vertices, and
+ * bottom-up stops at the first parent instead of looking at every edge. The search goes
+ * back to top-down when the frontier shrinks under V / BFS_BETA vertices. Top-down levels
+ * keep the frontier in a queue, bottom-up levels in a bitmap; a bottom-up level also fills
+ * the queue, so switching back costs nothing.
+ */
+#ifndef BFS_H
+#define BFS_H
+
+#include "bitset.h"
+#include "graph.h"
+
+#define BFS_ALPHA 15
+#define BFS_BETA 18
+
+typedef struct BfsLevel {
+    int depth;
+    bool bottomUp;
+    int frontier;              // Vertices expanded at this level
+    int64_t edges;             // Edges examined
+    double seconds;
+} BfsLevel;
+
+typedef struct BfsSearch {
+    int V;
+    int *hops;                 // Hops from the source, -1 when not reached
+    int *order;                // Vertices in the order they were reached since the last resetBfs
+    int reached;
+    int *queue;                // Current frontier as a list
+    int *nextQueue;
+    uint64_t *front;           // Current frontier as a bitmap, for bottom-up levels
+    uint64_t *next;
+    int words;
+    int64_t unexplored;        // In-edges of the vertices not reached yet
+    int64_t edges;             // Edges examined since the last resetBfs
+    int64_t total;             // Edges of the graph searched
+    BfsLevel *levels;          // Levels of the last search
+    int depth;
+    int capacity;
+} BfsSearch;
+
+GRAPH_API void resetBfs(BfsSearch *bfs, const Graph *graph) {
+    for (int v = 0; v < bfs->V; ++v) {
+        bfs->hops[v] = -1;
+    }
+    bfs->unexplored = bfs->total = graph->E;
+    bfs->edges = 0;
+    bfs->reached = 0;
+}
+
+GRAPH_API void initBfs(BfsSearch *bfs, const Graph *graph) {
+    int V = graph->V;
+    bfs->V = V;
+    bfs->hops = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    bfs->order = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    bfs->queue = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    bfs->nextQueue = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    bfs->words = bitWords(V);
+    bfs->front = newBits(bfs->words);
+    bfs->next = newBits(bfs->words);
+    bfs->capacity = 16;
+    bfs->levels = (BfsLevel *)xmalloc(bfs->capacity * sizeof(BfsLevel));
+    bfs->depth = 0;
+    resetBfs(bfs, graph);
+}
+
+GRAPH_API void freeBfs(BfsSearch *bfs) {
+    free(bfs->hops);
+    free(bfs->order);
+    free(bfs->queue);
+    free(bfs->nextQueue);
+    free(bfs->front);
+    free(bfs->next);
+    free(bfs->levels);
+}
+
+GRAPH_API int64_t outDegree(const Graph *graph, int v) {
+    return graph->offsets[v + 1] - graph->offsets[v];
+}
+
+// Function to expand the queue frontier along out-edges; returns the size of the next frontier
+GRAPH_API int topDownStep(const Graph *graph, const Graph *reverse, BfsSearch *bfs, int size, int depth, int64_t *frontierEdges) {
+    int next = 0;
+    *frontierEdges = 0;
+    for (int i = 0; i < size; ++i) {
+        int u = bfs->queue[i];
+        bfs->edges += outDegree(graph, u);
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+            int w = graph->dest[e];
+            if (bfs->hops[w] < 0) {
+                bfs->hops[w] = depth + 1;
+                bfs->order[bfs->reached++] = w;
+                bfs->nextQueue[next++] = w;
+                *frontierEdges += outDegree(graph, w);
+                bfs->unexplored -= outDegree(reverse, w);
+            }
+        }
+    }
+    return next;
+}
+
+// Function to let every unreached vertex look for a parent in the bitmap frontier along its
+// in-edges, stopping at the first one found
+GRAPH_API int bottomUpStep(const Graph *graph, const Graph *reverse, BfsSearch *bfs, int depth, int64_t *frontierEdges) {
+    int next = 0;
+    *frontierEdges = 0;
+    memset(bfs->next, 0, bfs->words * sizeof(uint64_t));
+    for (int v = 0; v < bfs->V; ++v) {
+        if (bfs->hops[v] >= 0) {
+            continue;
+        }
+        for (int64_t e = reverse->offsets[v]; e < reverse->offsets[v + 1]; ++e) {
+            bfs->edges++;
+            if (testBit(bfs->front, reverse->dest[e])) {
+                bfs->hops[v] = depth + 1;
+                bfs->order[bfs->reached++] = v;
+                bfs->nextQueue[next++] = v;
+                setBit(bfs->next, v);
+                *frontierEdges += outDegree(graph, v);
+                bfs->unexplored -= outDegree(reverse, v);
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+// Function to reach every vertex not reached yet from source, which must not be reached yet,
+// keeping the hops of earlier searches; reverse holds the in-edges (the graph itself when it
+// is symmetric, NULL to stay top-down). Returns the number of vertices reached.
+GRAPH_API int bfsFrom(const Graph *graph, const Graph *reverse, int source, BfsSearch *bfs) {
+    bfs->hops[source] = 0;
+    bfs->order[bfs->reached++] = source;
+    bfs->queue[0] = source;
+    bfs->unexplored -= reverse != NULL ? outDegree(reverse, source) : 0;
+    int size = 1;
+    int reached = 1;
+    int64_t frontierEdges = outDegree(graph, source);
+    bool bottomUp = false;
+    bfs->depth = 0;
+    int64_t examined = bfs->edges;
+
+    while (size > 0) {
+        // Beamer's switching rule: frontier edges against unexplored edges going bottom-up,
+        // frontier vertices against V going back top-down
+        if (reverse != NULL && !bottomUp && frontierEdges > bfs->unexplored / BFS_ALPHA) {
+            bottomUp = true;
+        } else if (bottomUp && size < bfs->V / BFS_BETA) {
+            bottomUp = false;
+        }
+        if (bottomUp) {
+            memset(bfs->front, 0, bfs->words * sizeof(uint64_t));
+            for (int i = 0; i < size; ++i) {
+                setBit(bfs->front, bfs->queue[i]);
+            }
+        }
+
+        double start = nowSeconds();
+        int64_t edges = bfs->edges;
+        int next = bottomUp ? bottomUpStep(graph, reverse, bfs, bfs->depth, &frontierEdges)
+                            : topDownStep(graph, reverse != NULL ? reverse : graph, bfs, size, bfs->depth, &frontierEdges);
+        if (bfs->depth == bfs->capacity) {
+            bfs->capacity *= 2;
+            bfs->levels = (BfsLevel *)xrealloc(bfs->levels, bfs->capacity * sizeof(BfsLevel));
+        }
+        BfsLevel *level = &bfs->levels[bfs->depth++];
+        level->depth = bfs->depth - 1;
+        level->bottomUp = bottomUp;
+        level->frontier = size;
+        level->edges = bfs->edges - edges;
+        level->seconds = nowSeconds() - start;
+
+        int *swap = bfs->queue;
+        bfs->queue = bfs->nextQueue;
+        bfs->nextQueue = swap;
+        size = next;
+        reached += next;
+    }
+    statAdd(STAT_EDGES_SCANNED, bfs->edges - examined);
+    statAdd(STAT_VERTICES_SETTLED, reached);
+    return reached;
+}
+
+// Function to print the per-level report of the last search
+GRAPH_API void printBfsLevels(const BfsSearch *bfs) {
+    printf("level\tmode\tfrontier\tedges\tms\n");
+    for (int d = 0; d < bfs->depth; ++d) {
+        const BfsLevel *level = &bfs->levels[d];
+        printf("%d\t%s\t%d\t%lld\t%.3f\n", level->depth, level->bottomUp ? "bottom-up" : "top-down", level->frontier,
+               (long long)level->edges, level->seconds * 1e3);
+    }
+}
+
+#endif // BFS_H
@@ -0,0 +1,239 @@
+/**
+ * @file bitset.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Bit-matrix adjacency for dense graphs, with vectorized row kernels.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Row u holds one bit per vertex, set when the edge u -> v exists, so an edge test is one
+ * load. Rows are padded to a multiple of 256 bits and aligned to 32 bytes, which lets the
+ * frontier kernel of bitComponents (OR with AND-NOT) run on whole AVX2 (or SSE2) registers
+ * with no tail loop. A bit matrix takes V^2 / 8 bytes, so it is only worth it when the graph
+ * is dense: useBitMatrix picks it when at least one pair in BITSET_MIN_DENSITY is an edge and
+ * the matrix stays under BITSET_MAX_BYTES.
+ */
+#ifndef BITSET_H
+#define BITSET_H
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "graph.h"
+
+#define BITSET_MIN_DENSITY 16
+#define BITSET_MAX_BYTES ((size_t)256 << 20)
+
+typedef struct BitMatrix {
+    int V;
+    int words;                 // 64-bit words per row, a multiple of 4
+    uint64_t *bits;
+} BitMatrix;
+
+// Function to round a bit count up to whole 256-bit blocks, in 64-bit words
+GRAPH_API int bitWords(int bits) {
+    return (int)(((int64_t)bits + 255) / 256 * 4);
+}
+
+// Function to allocate an all-zero bitset of the given number of words, aligned for the kernels
+GRAPH_API uint64_t *newBits(int64_t words) {
+    size_t size = (size_t)(words > 0 ? words : 4) * sizeof(uint64_t);
+    uint64_t *bits = (uint64_t *)aligned_alloc(32, size);
+    if (bits == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+    memset(bits, 0, size);
+    return bits;
+}
+
+GRAPH_API bool testBit(const uint64_t *bits, int i) {
+    return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+GRAPH_API void setBit(uint64_t *bits, int i) {
+    bits[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+GRAPH_API void clearBit(uint64_t *bits, int i) {
+    bits[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+
+// Function to tell whether a graph is dense enough for a bit matrix to pay off
+GRAPH_API bool useBitMatrix(const Graph *graph) {
+    double pairs = (double)graph->V * graph->V;
+    return graph->V > 0 && graph->E * (double)BITSET_MIN_DENSITY >= pairs &&
+           (size_t)graph->V * bitWords(graph->V) * sizeof(uint64_t) <= BITSET_MAX_BYTES;
+}
+
+// Function to transpose a 64 x 64 bit block in place (bit j of word i goes to bit i of word j)
+GRAPH_API void transposeBlock(uint64_t block[64]) {
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (int width = 32; width > 0; width >>= 1, mask ^= mask << width) {
+        for (int i = 0; i < 64; i = (i + width + 1) & ~width) {
+            uint64_t swap = ((block[i] >> width) ^ block[i + width]) & mask;
+            block[i] ^= swap << width;
+            block[i + width] ^= swap;
+        }
+    }
+}
+
+// Function to add the reverse of every edge, one pair of 64 x 64 blocks at a time; writing the
+// reverse edges one bit at a time would touch a different row for every edge
+GRAPH_API void symmetrizeBits(BitMatrix *matrix) {
+    int blocks = (matrix->V + 63) / 64;
+    uint64_t a[64], b[64];
+    for (int i = 0; i < blocks; ++i) {
+        for (int j = i; j < blocks; ++j) {
+            // a is block (i, j) and b is block (j, i); rows past V read as zero
+            for (int k = 0; k < 64; ++k) {
+                int64_t ra = (int64_t)i * 64 + k, rb = (int64_t)j * 64 + k;
+                a[k] = ra < matrix->V ? matrix->bits[ra * matrix->words + j] : 0;
+                b[k] = rb < matrix->V ? matrix->bits[rb * matrix->words + i] : 0;
+            }
+            transposeBlock(a);
+            transposeBlock(b);
+            for (int k = 0; k < 64; ++k) {
+                int64_t ra = (int64_t)i * 64 + k, rb = (int64_t)j * 64 + k;
+                if (ra < matrix->V) {
+                    matrix->bits[ra * matrix->words + j] |= b[k];
+                }
+                if (rb < matrix->V) {
+                    matrix->bits[rb * matrix->words + i] |= a[k];
+                }
+            }
+        }
+    }
+}
+
+// Function to build the bit matrix of a graph; with symmetrize every edge is set both ways
+GRAPH_API void initBitMatrix(BitMatrix *matrix, const Graph *graph, bool symmetrize) {
+    matrix->V = graph->V;
+    matrix->words = bitWords(graph->V);
+    matrix->bits = newBits((int64_t)graph->V * matrix->words);
+    for (int u = 0; u < graph->V; ++u) {
+        uint64_t *row = matrix->bits + (int64_t)u * matrix->words;
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+            setBit(row, graph->dest[e]);
+        }
+    }
+    if (symmetrize) {
+        symmetrizeBits(matrix);
+    }
+}
+
+GRAPH_API void freeBitMatrix(BitMatrix *matrix) {
+    free(matrix->bits);
+}
+
+GRAPH_API const uint64_t *bitRow(const BitMatrix *matrix, int u) {
+    return matrix->bits + (int64_t)u * matrix->words;
+}
+
+GRAPH_API bool hasBitEdge(const BitMatrix *matrix, int u, int v) {
+    return testBit(bitRow(matrix, u), v);
+}
+
+// Kernels over rows of 'words' words (a multiple of 4, 32-byte aligned)
+
+// Function to compute out |= a & ~b, the members of a not yet in b
+GRAPH_API void orAndNotBits(uint64_t *out, const uint64_t *a, const uint64_t *b, int words) {
+#if defined(__AVX2__)
+    for (int i = 0; i < words; i += 4) {
+        __m256i x = _mm256_andnot_si256(_mm256_load_si256((const __m256i *)(b + i)), _mm256_load_si256((const __m256i *)(a + i)));
+        _mm256_store_si256((__m256i *)(out + i), _mm256_or_si256(_mm256_load_si256((const __m256i *)(out + i)), x));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < words; i += 2) {
+        __m128i x = _mm_andnot_si128(_mm_load_si128((const __m128i *)(b + i)), _mm_load_si128((const __m128i *)(a + i)));
+        _mm_store_si128((__m128i *)(out + i), _mm_or_si128(_mm_load_si128((const __m128i *)(out + i)), x));
+    }
+#else
+    for (int i = 0; i < words; ++i) {
+        out[i] |= a[i] & ~b[i];
+    }
+#endif
+}
+
+// Function to compute out |= a, returning whether out gained a bit
+GRAPH_API bool orBits(uint64_t *out, const uint64_t *a, int words) {
+    uint64_t gained = 0;
+    for (int i = 0; i < words; ++i) {
+        gained |= a[i] & ~out[i];
+        out[i] |= a[i];
+    }
+    return gained != 0;
+}
+
+// Function to count the bits set in both a and b; the compiler turns the loop into popcnt
+// (or a vector popcount) when the target has one
+GRAPH_API int64_t andCountBits(const uint64_t *a, const uint64_t *b, int words) {
+    int64_t count = 0;
+    for (int i = 0; i < words; ++i) {
+        count += __builtin_popcountll(a[i] & b[i]);
+    }
+    return count;
+}
+
+// Function to find the first set bit at or after 'from', or -1
+GRAPH_API int nextBit(const uint64_t *bits, int words, int from) {
+    int i = from >> 6;
+    if (i >= words) {
+        return -1;
+    }
+    uint64_t word = bits[i] & (~(uint64_t)0 << (from & 63));
+    while (word == 0) {
+        if (++i == words) {
+            return -1;
+        }
+        word = bits[i];
+    }
+    return i * 64 + __builtin_ctzll(word);
+}
+
+// Function to label the vertices reached from each unvisited vertex in turn, in order of
+// smallest vertex, expanding a whole frontier bitset per level; returns the component count.
+// The matrix must be symmetric for these to be connected components.
+GRAPH_API int bitComponents(const BitMatrix *matrix, int *id) {
+    int words = matrix->words;
+    uint64_t *visited = newBits(words);
+    uint64_t *frontier = newBits(words);
+    uint64_t *next = newBits(words);
+    int components = 0;
+    for (int s = 0; s < matrix->V; ++s) {
+        if (testBit(visited, s)) {
+            continue;
+        }
+        memset(frontier, 0, words * sizeof(uint64_t));
+        setBit(frontier, s);
+        setBit(visited, s);
+        id[s] = components;
+        for (;;) {
+            memset(next, 0, words * sizeof(uint64_t));
+            for (int u = nextBit(frontier, words, 0); u >= 0; u = nextBit(frontier, words, u + 1)) {
+                orAndNotBits(next, bitRow(matrix, u), visited, words);
+            }
+            if (!orBits(visited, next, words)) {
+                break;
+            }
+            for (int v = nextBit(next, words, 0); v >= 0; v = nextBit(next, words, v + 1)) {
+                id[v] = components;
+            }
+            uint64_t *swap = frontier;
+            frontier = next;
+            next = swap;
+        }
+        components++;
+    }
+    free(visited);
+    free(frontier);
+    free(next);
+    return components;
+}
+
+#endif // BITSET_H
@@ -0,0 +1,242 @@
+/**
+ * @file buckets.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Monotone priority queues for small non-negative integer keys: Dial's buckets and a radix heap.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Both queues rely on what Dijkstra guarantees: a popped key is never smaller than the one
+ * popped before it. BucketQueue is Dial's circular array of maxStep + 1 buckets, each a
+ * doubly linked list threaded through per-vertex arrays, so push, decrease-key and remove
+ * are O(1) and a pop only walks the empty buckets between two keys. It needs every key in
+ * the queue to lie within maxStep of the last popped one, which holds when maxStep is the
+ * largest edge weight. RadixHeap needs no bound: bucket i holds the entries whose key first
+ * differs from the last popped key in bit i - 1, so an entry only moves to lower buckets,
+ * at most 64 times. It keeps stale entries instead of decreasing keys; the caller skips an
+ * entry whose key is no longer the vertex's distance.
+ */
+#ifndef BUCKETS_H
+#define BUCKETS_H
+
+#include "graph.h"
+
+typedef struct BucketQueue {
+    int V;
+    int width;           // Number of buckets: the largest step plus one
+    int *head;           // First vertex of each bucket, or -1
+    int *next;           // Links of the bucket lists
+    int *prev;           // -1 for the first vertex of a bucket
+    int *bucket;         // Bucket of each vertex, or -1 when it is not in the queue
+    int64_t cursor;      // No key in the queue is smaller
+    int current;         // Bucket of the cursor key
+    int64_t size;
+    int64_t pushes;      // Operations since the last publishBucketStats
+    int64_t decreases;
+    int64_t pops;
+} BucketQueue;
+
+// Function to create an empty queue for vertices 0 .. V - 1 whose keys stay within maxStep
+// of the last popped key
+GRAPH_API void initBucketQueue(BucketQueue *queue, int V, int maxStep) {
+    queue->V = V;
+    queue->width = maxStep + 1;
+    queue->head = (int *)xmalloc(queue->width * sizeof(int));
+    queue->next = (int *)xmalloc(V * sizeof(int));
+    queue->prev = (int *)xmalloc(V * sizeof(int));
+    queue->bucket = (int *)xmalloc(V * sizeof(int));
+    queue->cursor = 0;
+    queue->current = 0;
+    queue->size = 0;
+    queue->pushes = queue->decreases = queue->pops = 0;
+    memset(queue->head, -1, queue->width * sizeof(int));
+    memset(queue->bucket, -1, V * sizeof(int));
+}
+
+GRAPH_API void freeBucketQueue(BucketQueue *queue) {
+    free(queue->head);
+    free(queue->next);
+    free(queue->prev);
+    free(queue->bucket);
+}
+
+// Function to empty the queue for another run; a queue left empty by its run costs nothing
+GRAPH_API void clearBucketQueue(BucketQueue *queue) {
+    if (queue->size > 0) {
+        memset(queue->head, -1, queue->width * sizeof(int));
+        memset(queue->bucket, -1, queue->V * sizeof(int));
+    }
+    queue->cursor = 0;
+    queue->current = 0;
+    queue->size = 0;
+}
+
+GRAPH_API bool bucketEmpty(const BucketQueue *queue) {
+    return queue->size == 0;
+}
+
+GRAPH_API void unlinkBucket(BucketQueue *queue, int v) {
+    int before = queue->prev[v];
+    int after = queue->next[v];
+    if (before >= 0) {
+        queue->next[before] = after;
+    } else {
+        queue->head[queue->bucket[v]] = after;
+    }
+    if (after >= 0) {
+        queue->prev[after] = before;
+    }
+}
+
+// Function to insert v with the given key, or move it to the key when it is already queued
+GRAPH_API void bucketPushOrDecrease(BucketQueue *queue, int v, int64_t key) {
+    if (queue->bucket[v] >= 0) {
+        unlinkBucket(queue, v);
+        STAT_INC(queue->decreases);
+    } else {
+        queue->size++;
+        STAT_INC(queue->pushes);
+    }
+    // The key is less than width past the cursor, so it wraps around at most once
+    int bucket = queue->current + (int)(key - queue->cursor);
+    bucket -= bucket >= queue->width ? queue->width : 0;
+    queue->bucket[v] = bucket;
+    queue->prev[v] = -1;
+    queue->next[v] = queue->head[bucket];
+    if (queue->next[v] >= 0) {
+        queue->prev[queue->next[v]] = v;
+    }
+    queue->head[bucket] = v;
+}
+
+// Function to remove and return a vertex with the smallest key, which goes to *key
+GRAPH_API int bucketPop(BucketQueue *queue, int64_t *key) {
+    while (queue->head[queue->current] < 0) {
+        queue->cursor++;
+        queue->current = queue->current + 1 == queue->width ? 0 : queue->current + 1;
+    }
+    int v = queue->head[queue->current];
+    queue->head[queue->current] = queue->next[v];
+    if (queue->next[v] >= 0) {
+        queue->prev[queue->next[v]] = -1;
+    }
+    queue->bucket[v] = -1;
+    queue->size--;
+    STAT_INC(queue->pops);
+    *key = queue->cursor;
+    return v;
+}
+
+GRAPH_API void publishBucketStats(BucketQueue *queue) {
+    statAdd(STAT_HEAP_PUSHES, queue->pushes);
+    statAdd(STAT_HEAP_DECREASES, queue->decreases);
+    statAdd(STAT_HEAP_POPS, queue->pops);
+    queue->pushes = queue->decreases = queue->pops = 0;
+}
+
+#define RADIX_BUCKETS 65
+
+typedef struct RadixEntry {
+    int64_t key;
+    int vertex;
+} RadixEntry;
+
+typedef struct RadixHeap {
+    RadixEntry *bucket[RADIX_BUCKETS];
+    int64_t used[RADIX_BUCKETS];
+    int64_t capacity[RADIX_BUCKETS];
+    int64_t last;        // Last popped key; every key in the heap is at least this
+    int64_t size;
+    int64_t pushes;      // Operations since the last publishRadixStats
+    int64_t pops;
+} RadixHeap;
+
+GRAPH_API void initRadixHeap(RadixHeap *heap) {
+    for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        heap->bucket[b] = NULL;
+        heap->used[b] = heap->capacity[b] = 0;
+    }
+    heap->last = 0;
+    heap->size = 0;
+    heap->pushes = heap->pops = 0;
+}
+
+GRAPH_API void freeRadixHeap(RadixHeap *heap) {
+    for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        free(heap->bucket[b]);
+    }
+}
+
+// Function to empty the heap for another run, keeping the memory of its buckets
+GRAPH_API void clearRadixHeap(RadixHeap *heap) {
+    for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        heap->used[b] = 0;
+    }
+    heap->last = 0;
+    heap->size = 0;
+}
+
+GRAPH_API bool radixEmpty(const RadixHeap *heap) {
+    return heap->size == 0;
+}
+
+// Function to find the bucket of a key: 0 when it equals the last popped key, else one plus
+// the highest bit where they differ
+GRAPH_API int radixBucket(const RadixHeap *heap, int64_t key) {
+    uint64_t diff = (uint64_t)key ^ (uint64_t)heap->last;
+    return diff == 0 ? 0 : 64 - __builtin_clzll(diff);
+}
+
+GRAPH_API void radixAppend(RadixHeap *heap, int b, int64_t key, int vertex) {
+    if (heap->used[b] == heap->capacity[b]) {
+        heap->capacity[b] = heap->capacity[b] ? heap->capacity[b] * 2 : 64;
+        heap->bucket[b] = (RadixEntry *)xrealloc(heap->bucket[b], heap->capacity[b] * sizeof(RadixEntry));
+    }
+    RadixEntry *entry = &heap->bucket[b][heap->used[b]++];
+    entry->key = key;
+    entry->vertex = vertex;
+}
+
+// Function to insert an entry; the key must not be below the last popped key
+GRAPH_API void radixPush(RadixHeap *heap, int vertex, int64_t key) {
+    radixAppend(heap, radixBucket(heap, key), key, vertex);
+    heap->size++;
+    STAT_INC(heap->pushes);
+}
+
+// Function to remove an entry with the smallest key, returning its vertex and putting the key in *key
+GRAPH_API int radixPop(RadixHeap *heap, int64_t *key) {
+    if (heap->used[0] == 0) {
+        // Refill bucket 0: the smallest key of the first non-empty bucket becomes the last key,
+        // and every entry of that bucket moves to a lower one
+        int b = 1;
+        while (heap->used[b] == 0) {
+            b++;
+        }
+        RadixEntry *entries = heap->bucket[b];
+        int64_t count = heap->used[b];
+        int64_t smallest = entries[0].key;
+        for (int64_t i = 1; i < count; ++i) {
+            smallest = entries[i].key < smallest ? entries[i].key : smallest;
+        }
+        heap->last = smallest;
+        heap->used[b] = 0;
+        for (int64_t i = 0; i < count; ++i) {
+            radixAppend(heap, radixBucket(heap, entries[i].key), entries[i].key, entries[i].vertex);
+        }
+    }
+    RadixEntry entry = heap->bucket[0][--heap->used[0]];
+    heap->size--;
+    STAT_INC(heap->pops);
+    *key = entry.key;
+    return entry.vertex;
+}
+
+GRAPH_API void publishRadixStats(RadixHeap *heap) {
+    statAdd(STAT_HEAP_PUSHES, heap->pushes);
+    statAdd(STAT_HEAP_POPS, heap->pops);
+    heap->pushes = heap->pops = 0;
+}
+
+#endif // BUCKETS_H
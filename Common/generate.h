@@ -0,0 +1,383 @@
+/**
+ * @file generate.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Seeded generators of synthetic graphs, and writers for the text formats.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Every generator returns a simple undirected graph: each edge is stored in both directions,
+ * with the same weight, and there are no self-loops or repeated edges. The weight of an edge
+ * is a hash of its two ends and the seed, so both directions (and repeated draws of the same
+ * pair) always agree. The same family, size and seed give the same graph on every machine.
+ *
+ *  - Erdos-Renyi G(n, m): m distinct edges drawn uniformly;
+ *  - R-MAT: 2^scale vertices, edges placed by recursive quadrant choices (Graph500
+ *    probabilities 0.57 / 0.19 / 0.19 / 0.05), vertex ids shuffled to hide the hubs' order;
+ *  - grid: rows x cols lattice with 4 neighbours, a road-like graph of large diameter;
+ *  - random regular: every vertex has the same degree (configuration model, with repeated
+ *    edges and self-loops removed by random edge switches).
+ */
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include "loader.h"
+
+#define RMAT_A 0.57
+#define RMAT_B 0.19
+#define RMAT_C 0.19
+
+typedef struct GraphRng {
+    uint64_t state;
+} GraphRng;
+
+GRAPH_API void seedRng(GraphRng *rng, uint64_t seed) {
+    rng->state = seed * 0x9e3779b97f4a7c15ull + 0x632be59bd9b4e019ull;
+}
+
+// Function to draw 64 random bits (splitmix64)
+GRAPH_API uint64_t nextRandom(GraphRng *rng) {
+    uint64_t z = (rng->state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Function to draw an integer in [0, n)
+GRAPH_API int64_t randomBelow(GraphRng *rng, int64_t n) {
+    return (int64_t)((unsigned __int128)nextRandom(rng) * (uint64_t)n >> 64);
+}
+
+// Function to draw a real in [0, 1)
+GRAPH_API double randomUnit(GraphRng *rng) {
+    return (nextRandom(rng) >> 11) * 0x1.0p-53;
+}
+
+// Function to give the edge {u, v} a weight in [1, maxWeight] that does not depend on direction
+GRAPH_API int edgeWeight(int u, int v, int maxWeight, uint64_t seed) {
+    uint64_t lo = u < v ? u : v, hi = u < v ? v : u;
+    GraphRng rng;
+    seedRng(&rng, seed ^ (lo << 32 | hi));
+    return 1 + (int)randomBelow(&rng, maxWeight);
+}
+
+GRAPH_API void addUndirectedEdge(GraphBuilder *builder, int u, int v, int maxWeight, uint64_t seed) {
+    int weight = edgeWeight(u, v, maxWeight, seed);
+    addEdge(builder, u, v, weight);
+    addEdge(builder, v, u, weight);
+}
+
+// Function to drop self-loops and repeated destinations from every row, in place; rows are
+// sorted, so repeats are neighbours
+GRAPH_API void simplifyGraph(Graph *graph) {
+    int64_t out = 0;
+    int64_t begin = 0;
+    for (int u = 0; u < graph->V; ++u) {
+        int64_t end = graph->offsets[u + 1];
+        graph->offsets[u] = out;
+        for (int64_t e = begin; e < end; ++e) {
+            int v = graph->dest[e];
+            if (v == u || (e > begin && graph->dest[e - 1] == v)) {
+                continue;
+            }
+            graph->dest[out] = v;
+            graph->weight[out++] = graph->weight[e];
+        }
+        begin = end;
+    }
+    graph->offsets[graph->V] = out;
+    graph->E = out;
+}
+
+// Function to generate G(n, m) with m distinct undirected edges
+GRAPH_API Graph *erdosRenyiGraph(int V, int64_t edges, int maxWeight, uint64_t seed) {
+    int64_t pairs = (int64_t)V * (V - 1) / 2;
+    if (V < 2 || edges > pairs / 2) {
+        printf("Erdos-Renyi: %lld edges do not fit sparsely in %d vertices.\n", (long long)edges, V);
+        exit(1);
+    }
+    GraphRng rng;
+    seedRng(&rng, seed);
+    GraphBuilder builder;
+    initGraphBuilder(&builder, V);
+    for (int64_t i = 0; i < edges; ++i) {
+        int u = (int)randomBelow(&rng, V);
+        int v = (int)randomBelow(&rng, V);
+        if (u != v) {
+            addUndirectedEdge(&builder, u, v, maxWeight, seed);
+        }
+    }
+    // Redraw the self-loops and repeats until every edge is distinct
+    Graph *graph = buildGraph(&builder, NULL);
+    simplifyGraph(graph);
+    while (graph->E < 2 * edges) {
+        initGraphBuilder(&builder, V);
+        for (int u = 0; u < V; ++u) {
+            for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+                addEdge(&builder, u, graph->dest[e], graph->weight[e]);
+            }
+        }
+        for (int64_t i = graph->E / 2; i < edges; ++i) {
+            int u = (int)randomBelow(&rng, V);
+            int v = (int)randomBelow(&rng, V);
+            if (u != v) {
+                addUndirectedEdge(&builder, u, v, maxWeight, seed);
+            }
+        }
+        freeGraph(graph);
+        graph = buildGraph(&builder, NULL);
+        simplifyGraph(graph);
+    }
+    return graph;
+}
+
+// Function to generate an R-MAT graph with 2^scale vertices and edgeFactor * 2^scale draws;
+// repeated draws and self-loops are dropped, so the graph ends up with somewhat fewer edges
+GRAPH_API Graph *rmatGraph(int scale, int edgeFactor, int maxWeight, uint64_t seed) {
+    if (scale < 1 || scale > 30) {
+        printf("R-MAT: the scale must be between 1 and 30.\n");
+        exit(1);
+    }
+    int V = 1 << scale;
+    GraphRng rng;
+    seedRng(&rng, seed);
+    int *shuffle = (int *)xmalloc(V * sizeof(int));
+    for (int v = 0; v < V; ++v) {
+        shuffle[v] = v;
+    }
+    for (int v = V - 1; v > 0; --v) {
+        int w = (int)randomBelow(&rng, v + 1);
+        int swap = shuffle[v];
+        shuffle[v] = shuffle[w];
+        shuffle[w] = swap;
+    }
+
+    GraphBuilder builder;
+    initGraphBuilder(&builder, V);
+    int64_t draws = (int64_t)edgeFactor << scale;
+    for (int64_t i = 0; i < draws; ++i) {
+        int u = 0, v = 0;
+        for (int bit = scale - 1; bit >= 0; --bit) {
+            double r = randomUnit(&rng);
+            if (r >= RMAT_A + RMAT_B + RMAT_C) {
+                u |= 1 << bit;
+                v |= 1 << bit;
+            } else if (r >= RMAT_A + RMAT_B) {
+                u |= 1 << bit;
+            } else if (r >= RMAT_A) {
+                v |= 1 << bit;
+            }
+        }
+        if (u != v) {
+            addUndirectedEdge(&builder, shuffle[u], shuffle[v], maxWeight, seed);
+        }
+    }
+    free(shuffle);
+    Graph *graph = buildGraph(&builder, NULL);
+    simplifyGraph(graph);
+    return graph;
+}
+
+// Function to generate a rows x cols grid, each vertex linked to the ones beside and below it
+GRAPH_API Graph *gridGraph(int rows, int cols, int maxWeight, uint64_t seed) {
+    if (rows < 1 || cols < 1 || (int64_t)rows * cols >= INT32_MAX) {
+        printf("Grid: %d x %d is not a valid size.\n", rows, cols);
+        exit(1);
+    }
+    GraphBuilder builder;
+    initGraphBuilder(&builder, rows * cols);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            int v = r * cols + c;
+            if (c + 1 < cols) {
+                addUndirectedEdge(&builder, v, v + 1, maxWeight, seed);
+            }
+            if (r + 1 < rows) {
+                addUndirectedEdge(&builder, v, v + cols, maxWeight, seed);
+            }
+        }
+    }
+    return buildGraph(&builder, NULL);
+}
+
+// Multiset of undirected edges, by open addressing; a count of 0 means absent
+typedef struct EdgeCounts {
+    uint64_t *keys;
+    int *counts;
+    int64_t mask;
+} EdgeCounts;
+
+GRAPH_API uint64_t edgeKey(int u, int v) {
+    uint64_t lo = u < v ? u : v, hi = u < v ? v : u;
+    return lo << 32 | hi;
+}
+
+// Function to find the slot of a key, claiming an empty one when it is new
+GRAPH_API int *edgeCount(EdgeCounts *set, uint64_t key) {
+    int64_t i = (int64_t)((key * 0x9e3779b97f4a7c15ull) >> 20) & set->mask;
+    while (set->keys[i] != key && set->keys[i] != UINT64_MAX) {
+        i = (i + 1) & set->mask;
+    }
+    set->keys[i] = key;
+    return &set->counts[i];
+}
+
+// Function to generate a random degree-regular graph on V vertices
+GRAPH_API Graph *regularGraph(int V, int degree, int maxWeight, uint64_t seed) {
+    if (degree < 1 || degree >= V || ((int64_t)V * degree) % 2 != 0 || (V > 2 && degree > V / 2)) {
+        printf("Random regular: degree %d does not fit %d vertices (at most V / 2, and V * degree even).\n", degree, V);
+        exit(1);
+    }
+    GraphRng rng;
+    seedRng(&rng, seed);
+    int64_t edges = (int64_t)V * degree / 2;
+
+    // Configuration model: shuffle the degree * V stubs and pair them up
+    int *ends = (int *)xmalloc(2 * edges * sizeof(int));
+    for (int64_t i = 0; i < 2 * edges; ++i) {
+        ends[i] = (int)(i / degree);
+    }
+    for (int64_t i = 2 * edges - 1; i > 0; --i) {
+        int64_t j = randomBelow(&rng, i + 1);
+        int swap = ends[i];
+        ends[i] = ends[j];
+        ends[j] = swap;
+    }
+
+    EdgeCounts set;
+    int64_t slots = 1;
+    while (slots < 4 * edges) {
+        slots *= 2;
+    }
+    set.keys = (uint64_t *)xmalloc(slots * sizeof(uint64_t));
+    set.counts = (int *)xmalloc(slots * sizeof(int));
+    memset(set.keys, 0xff, slots * sizeof(uint64_t));
+    memset(set.counts, 0, slots * sizeof(int));
+    set.mask = slots - 1;
+
+    // Keep the first copy of every pair; self-loops and later copies are bad
+    bool *bad = (bool *)xmalloc(edges * sizeof(bool));
+    for (int64_t k = 0; k < edges; ++k) {
+        int u = ends[2 * k], v = ends[2 * k + 1];
+        int *count = u != v ? edgeCount(&set, edgeKey(u, v)) : NULL;
+        bad[k] = count == NULL || *count > 0;
+        if (!bad[k]) {
+            (*count)++;
+        }
+    }
+
+    // Switch every bad edge {a, b} with a random good edge {c, d} into {a, c} and {b, d}
+    for (int64_t k = 0; k < edges; ++k) {
+        while (bad[k]) {
+            int64_t j = randomBelow(&rng, edges);
+            if (bad[j]) {
+                continue;
+            }
+            int a = ends[2 * k], b = ends[2 * k + 1];
+            int flip = (int)randomBelow(&rng, 2);
+            int c = ends[2 * j + flip], d = ends[2 * j + 1 - flip];
+            if (a == c || b == d || edgeKey(a, c) == edgeKey(b, d) ||
+                *edgeCount(&set, edgeKey(a, c)) > 0 || *edgeCount(&set, edgeKey(b, d)) > 0) {
+                continue;
+            }
+            (*edgeCount(&set, edgeKey(c, d)))--;
+            (*edgeCount(&set, edgeKey(a, c)))++;
+            (*edgeCount(&set, edgeKey(b, d)))++;
+            ends[2 * j] = a;
+            ends[2 * j + 1] = c;
+            ends[2 * k] = b;
+            ends[2 * k + 1] = d;
+            bad[k] = false;
+        }
+    }
+
+    GraphBuilder builder;
+    initGraphBuilder(&builder, V);
+    for (int64_t k = 0; k < edges; ++k) {
+        addUndirectedEdge(&builder, ends[2 * k], ends[2 * k + 1], maxWeight, seed);
+    }
+    free(ends);
+    free(bad);
+    free(set.keys);
+    free(set.counts);
+    return buildGraph(&builder, NULL);
+}
+
+// Function to generate a graph of a family given by name ("er", "rmat", "grid" or "regular")
+// from its two size parameters; returns NULL for an unknown family
+GRAPH_API Graph *generateGraph(const char *family, int64_t first, int64_t second, int maxWeight, uint64_t seed) {
+    if (first < 0 || first > INT32_MAX || second < 0 || (strcmp(family, "er") != 0 && second > INT32_MAX)) {
+        printf("%s: size out of range.\n", family);
+        exit(1);
+    }
+    if (strcmp(family, "er") == 0) {
+        return erdosRenyiGraph((int)first, second, maxWeight, seed);
+    }
+    if (strcmp(family, "rmat") == 0) {
+        return rmatGraph((int)first, (int)second, maxWeight, seed);
+    }
+    if (strcmp(family, "grid") == 0) {
+        return gridGraph((int)first, (int)second, maxWeight, seed);
+    }
+    if (strcmp(family, "regular") == 0) {
+        return regularGraph((int)first, (int)second, maxWeight, seed);
+    }
+    return NULL;
+}
+
+// Function to rename every vertex by a random permutation, giving an isomorphic copy
+GRAPH_API Graph *permuteGraph(const Graph *graph, uint64_t seed) {
+    GraphRng rng;
+    seedRng(&rng, seed);
+    int *name = (int *)xmalloc((graph->V > 0 ? graph->V : 1) * sizeof(int));
+    for (int v = 0; v < graph->V; ++v) {
+        name[v] = v;
+    }
+    for (int v = graph->V - 1; v > 0; --v) {
+        int w = (int)randomBelow(&rng, v + 1);
+        int swap = name[v];
+        name[v] = name[w];
+        name[w] = swap;
+    }
+    GraphBuilder builder;
+    initGraphBuilder(&builder, graph->V);
+    for (int u = 0; u < graph->V; ++u) {
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+            addEdge(&builder, name[u], name[graph->dest[e]], graph->weight[e]);
+        }
+    }
+    free(name);
+    return buildGraph(&builder, NULL);
+}
+
+// Function to write a graph as text: DIMACS ("p sp V E", 1-based) for .gr files, which keeps
+// vertices without edges, and an edge list ("src dst weight", 0-based) otherwise
+GRAPH_API void writeTextGraph(const Graph *graph, const char *fileName, const char *comment) {
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) {
+        printf("Cannot write %s.\n", fileName);
+        exit(1);
+    }
+    bool dimacs = hasExtension(fileName, ".gr");
+    if (dimacs) {
+        fprintf(file, "c %s\np sp %d %lld\n", comment, graph->V, (long long)graph->E);
+    } else {
+        fprintf(file, "# %s\n", comment);
+    }
+    for (int u = 0; u < graph->V; ++u) {
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+            if (dimacs) {
+                fprintf(file, "a %d %d %d\n", u + 1, graph->dest[e] + 1, graph->weight[e]);
+            } else {
+                fprintf(file, "%d %d %d\n", u, graph->dest[e], graph->weight[e]);
+            }
+        }
+    }
+    if (fclose(file) != 0) {
+        printf("Cannot write %s.\n", fileName);
+        exit(1);
+    }
+}
+
+#endif // GENERATE_H
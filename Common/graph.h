@@ -0,0 +1,400 @@
+/**
+ * @file graph.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Shared graph representation used by every tool, stored in compressed sparse row (CSR) form.
+ * @version 0.2
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * The neighbours of vertex v are dest[offsets[v]] .. dest[offsets[v + 1] - 1], with the
+ * matching weights at the same positions of weight[]. Every function lives in this header
+ * so each tool still builds from its single source file.
+ *
+ * A built graph keeps its arrays, its labels and the Graph itself in one arena, so freeGraph
+ * is a single freeArena. The builder stores edges in fixed mapped slabs rather than one
+ * array it keeps doubling, and buildGraph unmaps every slab as soon as its edges are placed.
+ */
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#define GRAPH_API static inline
+
+// Function to allocate memory or abort the program
+GRAPH_API void *xmalloc(size_t size) {
+    void *ptr = malloc(size ? size : 1);
+    if (ptr == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+// Function to resize memory or abort the program
+GRAPH_API void *xrealloc(void *ptr, size_t size) {
+    ptr = realloc(ptr, size ? size : 1);
+    if (ptr == NULL) {
+        printf("Out of memory.\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+// Function to read a monotonic clock, in seconds
+GRAPH_API double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#include "arena.h"
+#include "labels.h"
+#include "output.h"
+#include "stats.h"
+
+#define BUILDER_SLAB_EDGES (1 << 20)
+
+typedef struct Graph {
+    int V;
+    int64_t E;
+    LabelTable *labels; // Vertex names, or NULL when vertices are unnamed
+    int64_t *offsets; // V + 1 entries
+    int *dest;        // E entries, each row sorted by destination
+    int *weight;      // E entries
+    int minWeight;    // Smallest and largest edge weight, both 0 when there are no edges
+    int maxWeight;
+    void *mapping;    // Snapshot the arrays point into, or NULL when they were allocated
+    size_t mappingSize;
+    Arena arena;      // Holds the arrays, the labels and the Graph itself when mapping is NULL
+} Graph;
+
+typedef struct BuilderEdge {
+    int src;
+    int dest;
+    int weight;
+} BuilderEdge;
+
+// Edges collected while reading a file, turned into a Graph by buildGraph
+typedef struct GraphBuilder {
+    int V;
+    int64_t count;
+    BuilderEdge **slabs;       // BUILDER_SLAB_EDGES edges each, the last one partly filled
+    int slabCount;
+    int slabCapacity;
+} GraphBuilder;
+
+GRAPH_API void initGraphBuilder(GraphBuilder *builder, int V) {
+    builder->V = V;
+    builder->count = 0;
+    builder->slabs = NULL;
+    builder->slabCount = 0;
+    builder->slabCapacity = 0;
+}
+
+// Function to add an edge to the builder
+GRAPH_API void addEdge(GraphBuilder *builder, int src, int dest, int weight) {
+    int64_t slot = builder->count % BUILDER_SLAB_EDGES;
+    if (slot == 0) {
+        if (builder->slabCount == builder->slabCapacity) {
+            builder->slabCapacity = builder->slabCapacity ? builder->slabCapacity * 2 : 16;
+            builder->slabs = (BuilderEdge **)xrealloc(builder->slabs, builder->slabCapacity * sizeof(BuilderEdge *));
+        }
+        builder->slabs[builder->slabCount++] = (BuilderEdge *)mapPages(BUILDER_SLAB_EDGES * sizeof(BuilderEdge));
+    }
+    BuilderEdge *edge = &builder->slabs[builder->slabCount - 1][slot];
+    edge->src = src;
+    edge->dest = dest;
+    edge->weight = weight;
+    builder->count++;
+}
+
+// Function to sort a row by destination, keeping edges with the same destination in the order
+// they were added; short rows use insertion sort, long ones a merge sort through scratch
+GRAPH_API void sortRow(int *dest, int *weight, int64_t n, int *scratch) {
+    if (n <= 32) {
+        for (int64_t i = 1; i < n; ++i) {
+            int d = dest[i], w = weight[i];
+            int64_t j = i;
+            for (; j > 0 && dest[j - 1] > d; --j) {
+                dest[j] = dest[j - 1];
+                weight[j] = weight[j - 1];
+            }
+            dest[j] = d;
+            weight[j] = w;
+        }
+        return;
+    }
+    int64_t half = n / 2;
+    sortRow(dest, weight, half, scratch);
+    sortRow(dest + half, weight + half, n - half, scratch);
+    if (dest[half - 1] <= dest[half]) {
+        return;
+    }
+    memcpy(scratch, dest, half * sizeof(int));
+    memcpy(scratch + half, weight, half * sizeof(int));
+    int64_t a = 0, b = half, k = 0;
+    while (a < half && b < n) {
+        if (dest[b] < scratch[a]) {
+            dest[k] = dest[b];
+            weight[k++] = weight[b++];
+        } else {
+            dest[k] = scratch[a];
+            weight[k++] = scratch[half + a++];
+        }
+    }
+    while (a < half) {
+        dest[k] = scratch[a];
+        weight[k++] = scratch[half + a++];
+    }
+}
+
+// Function to turn the collected edges into a Graph: count the edges of each source, place
+// every edge in its row (freeing each slab once it is placed), then sort the rows
+GRAPH_API Graph *buildGraph(GraphBuilder *builder, LabelTable *labels) {
+    int V = builder->V;
+    int64_t E = builder->count;
+
+    Arena arena;
+    initArena(&arena);
+    Graph *graph = (Graph *)arenaAlloc(&arena, sizeof(Graph));
+    graph->V = V;
+    graph->E = E;
+    graph->labels = NULL;
+    graph->mapping = NULL;
+    graph->mappingSize = 0;
+    graph->minWeight = E > 0 ? INT_MAX : 0;
+    graph->maxWeight = E > 0 ? INT_MIN : 0;
+    graph->offsets = (int64_t *)arenaAlloc(&arena, (V + 1) * sizeof(int64_t));
+    graph->dest = (int *)arenaAlloc(&arena, E * sizeof(int));
+    graph->weight = (int *)arenaAlloc(&arena, E * sizeof(int));
+    if (labels != NULL) {
+        graph->labels = copyLabels(labels, &arena);
+        freeLabels(labels);
+    }
+
+    memset(graph->offsets, 0, (V + 1) * sizeof(int64_t));
+    for (int64_t e = 0; e < E; ++e) {
+        graph->offsets[builder->slabs[e / BUILDER_SLAB_EDGES][e % BUILDER_SLAB_EDGES].src + 1]++;
+    }
+    for (int v = 0; v < V; ++v) {
+        graph->offsets[v + 1] += graph->offsets[v];
+    }
+
+    // Placing the edges in file order keeps same-destination edges in file order within a row
+    int64_t *next = (int64_t *)xmalloc((V + 1) * sizeof(int64_t));
+    memcpy(next, graph->offsets, (V + 1) * sizeof(int64_t));
+    for (int s = 0; s < builder->slabCount; ++s) {
+        int64_t first = (int64_t)s * BUILDER_SLAB_EDGES;
+        int64_t last = first + BUILDER_SLAB_EDGES < E ? first + BUILDER_SLAB_EDGES : E;
+        const BuilderEdge *slab = builder->slabs[s];
+        for (int64_t e = first; e < last; ++e) {
+            const BuilderEdge *edge = &slab[e - first];
+            int64_t slot = next[edge->src]++;
+            graph->dest[slot] = edge->dest;
+            graph->weight[slot] = edge->weight;
+            graph->minWeight = edge->weight < graph->minWeight ? edge->weight : graph->minWeight;
+            graph->maxWeight = edge->weight > graph->maxWeight ? edge->weight : graph->maxWeight;
+        }
+        munmap(builder->slabs[s], BUILDER_SLAB_EDGES * sizeof(BuilderEdge));
+    }
+    free(builder->slabs);
+    free(next);
+
+    int64_t longest = 0;
+    for (int v = 0; v < V; ++v) {
+        int64_t degree = graph->offsets[v + 1] - graph->offsets[v];
+        longest = degree > longest ? degree : longest;
+    }
+    int *scratch = (int *)xmalloc((longest + 1) * sizeof(int));
+    for (int v = 0; v < V; ++v) {
+        int64_t begin = graph->offsets[v];
+        sortRow(graph->dest + begin, graph->weight + begin, graph->offsets[v + 1] - begin, scratch);
+    }
+    free(scratch);
+
+    graph->arena = arena;
+    initGraphBuilder(builder, V);
+    return graph;
+}
+
+// Function to build the reverse graph (every edge u -> v becomes v -> u), without labels
+GRAPH_API Graph *transposeGraph(const Graph *graph) {
+    GraphBuilder builder;
+    initGraphBuilder(&builder, graph->V);
+    for (int u = 0; u < graph->V; ++u) {
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+            addEdge(&builder, graph->dest[e], u, graph->weight[e]);
+        }
+    }
+    return buildGraph(&builder, NULL);
+}
+
+// Function to find the edge u -> v by binary search in the sorted row; -1 when absent
+GRAPH_API int64_t findEdge(const Graph *graph, int u, int v) {
+    int64_t lo = graph->offsets[u];
+    int64_t hi = graph->offsets[u + 1];
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if (graph->dest[mid] == v) {
+            return mid;
+        }
+        if (graph->dest[mid] < v) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -1;
+}
+
+// Function to check that every edge u -> v has a twin v -> u of the same weight
+GRAPH_API bool isSymmetric(const Graph *graph) {
+    for (int u = 0; u < graph->V; ++u) {
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+            int64_t twin = findEdge(graph, graph->dest[e], u);
+            if (twin < 0 || graph->weight[twin] != graph->weight[e]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Function to check for two edges between the same ordered pair; rows are sorted, so they sit
+// next to each other
+GRAPH_API bool hasParallelEdges(const Graph *graph) {
+    for (int u = 0; u < graph->V; ++u) {
+        for (int64_t e = graph->offsets[u] + 1; e < graph->offsets[u + 1]; ++e) {
+            if (graph->dest[e] == graph->dest[e - 1]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Function to build the undirected version of a graph (every edge in both directions), without labels
+GRAPH_API Graph *undirectedGraph(const Graph *graph) {
+    GraphBuilder builder;
+    initGraphBuilder(&builder, graph->V);
+    for (int u = 0; u < graph->V; ++u) {
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+            addEdge(&builder, u, graph->dest[e], graph->weight[e]);
+            addEdge(&builder, graph->dest[e], u, graph->weight[e]);
+        }
+    }
+    return buildGraph(&builder, NULL);
+}
+
+GRAPH_API void freeGraph(Graph *graph) {
+    if (graph->mapping != NULL) {
+        munmap(graph->mapping, graph->mappingSize);
+        freeArena(&graph->arena);
+        free(graph);
+        return;
+    }
+    // The Graph lives in its own arena, so take the arena out before releasing it
+    Arena arena = graph->arena;
+    freeArena(&arena);
+}
+
+// Function to print the label of a vertex, or its number when the input had no labels
+GRAPH_API void printVertex(const Graph *graph, int v) {
+    if (graph->labels != NULL) {
+        fputs(labelName(graph->labels, v), stdout);
+    } else {
+        printf("%d", v);
+    }
+}
+
+// Function to print the label line of the graph
+GRAPH_API void printLabels(const Graph *graph) {
+    printLabelLine(graph->labels, graph->V);
+}
+
+// Function to find the vertex a command-line argument names: a vertex name when the graph has
+// one that matches, otherwise a vertex number; -1 when it is neither
+GRAPH_API int findVertex(const Graph *graph, const char *text) {
+    if (graph->labels != NULL) {
+        int v = findLabel(graph->labels, text, strlen(text));
+        if (v >= 0) {
+            return v;
+        }
+    }
+    char *end;
+    long v = strtol(text, &end, 10);
+    return end != text && *end == '\0' && v >= 0 && v < graph->V ? (int)v : -1;
+}
+
+// Function to write the label of a vertex, or its number, to the output buffer
+GRAPH_API void outputVertex(const Graph *graph, int v) {
+    if (graph->labels == NULL) {
+        outputInt(v);
+    } else if (outputFormat() == OUTPUT_CSV) {
+        outputCsvField(labelName(graph->labels, v));
+    } else {
+        outputBytes(labelName(graph->labels, v), labelLength(graph->labels, v));
+    }
+}
+
+// Function to print the adjacency list representation of the graph: one line per vertex as
+// text, one row per edge as CSV, or the offsets, dest and weight arrays as binary
+GRAPH_API void printGraph(const Graph *graph, bool showWeights) {
+    if (outputFormat() == OUTPUT_BINARY) {
+        outputBytes(graph->offsets, (graph->V + 1) * sizeof(int64_t));
+        outputBytes(graph->dest, graph->E * sizeof(int));
+        outputBytes(graph->weight, graph->E * sizeof(int));
+    } else if (outputFormat() == OUTPUT_CSV) {
+        outputText(showWeights ? "source,target,weight\n" : "source,target\n");
+        for (int v = 0; v < graph->V; ++v) {
+            for (int64_t e = graph->offsets[v]; e < graph->offsets[v + 1]; ++e) {
+                outputVertex(graph, v);
+                outputChar(',');
+                outputVertex(graph, graph->dest[e]);
+                if (showWeights) {
+                    outputChar(',');
+                    outputInt(graph->weight[e]);
+                }
+                outputChar('\n');
+            }
+        }
+    } else {
+        for (int v = 0; v < graph->V; ++v) {
+            outputText("Adjacencies of vertex ");
+            outputVertex(graph, v);
+            outputText(": ");
+            for (int64_t e = graph->offsets[v]; e < graph->offsets[v + 1]; ++e) {
+                outputVertex(graph, graph->dest[e]);
+                if (showWeights) {
+                    outputText(" (");
+                    outputInt(graph->weight[e]);
+                    outputChar(')');
+                }
+                outputText(" -> ");
+            }
+            outputText("NULL\n");
+        }
+    }
+    outputFlush();
+}
+
+// Function to print the graph under its title and label line; CSV and binary output get the
+// edges alone
+GRAPH_API void printAdjacency(const Graph *graph, bool showWeights) {
+    if (outputFormat() == OUTPUT_TEXT) {
+        printf("Graph:\n");
+        printLabels(graph);
+    }
+    printGraph(graph, showWeights);
+}
+
+#endif // GRAPH_H
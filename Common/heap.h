@@ -0,0 +1,176 @@
+/**
+ * @file heap.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Indexed 4-ary min-heap of vertices with decrease-key.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Four children per node halve the depth of a binary heap, and the children of a node
+ * share a cache line, so sift-down costs fewer misses.
+ */
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "graph.h"
+
+#define HEAP_ARITY 4
+
+typedef struct IndexedHeap {
+    int size;
+    int capacity;
+    int *items;      // Heap slots, holding vertices
+    int *position;   // Slot of each vertex, or -1 when it is not in the heap
+    int64_t *key;    // Key of each vertex
+    int64_t *tie;    // Optional second key, compared only between equal keys; NULL when unused
+    int64_t pushes;  // Operations since the last publishHeapStats
+    int64_t decreases;
+    int64_t pops;
+} IndexedHeap;
+
+// Function to create an empty heap able to hold vertices 0 .. capacity - 1
+GRAPH_API void initHeap(IndexedHeap *heap, int capacity) {
+    heap->size = 0;
+    heap->capacity = capacity;
+    heap->items = (int *)xmalloc(capacity * sizeof(int));
+    heap->position = (int *)xmalloc(capacity * sizeof(int));
+    heap->key = (int64_t *)xmalloc(capacity * sizeof(int64_t));
+    heap->tie = NULL;
+    heap->pushes = heap->decreases = heap->pops = 0;
+    for (int v = 0; v < capacity; ++v) {
+        heap->position[v] = -1;
+    }
+}
+
+GRAPH_API void freeHeap(IndexedHeap *heap) {
+    free(heap->items);
+    free(heap->position);
+    free(heap->key);
+    free(heap->tie);
+}
+
+// Function to make equal keys fall back to a second key, so the pop order is total
+GRAPH_API void enableHeapTies(IndexedHeap *heap) {
+    heap->tie = (int64_t *)xmalloc(heap->capacity * sizeof(int64_t));
+}
+
+// Function to empty the heap in O(size), leaving it ready for another run
+GRAPH_API void clearHeap(IndexedHeap *heap) {
+    for (int i = 0; i < heap->size; ++i) {
+        heap->position[heap->items[i]] = -1;
+    }
+    heap->size = 0;
+}
+
+GRAPH_API bool heapEmpty(const IndexedHeap *heap) {
+    return heap->size == 0;
+}
+
+GRAPH_API bool inHeap(const IndexedHeap *heap, int v) {
+    return heap->position[v] >= 0;
+}
+
+// Function to tell whether vertex a comes out of the heap before vertex b
+GRAPH_API bool heapBefore(const IndexedHeap *heap, int a, int b) {
+    if (heap->key[a] != heap->key[b]) {
+        return heap->key[a] < heap->key[b];
+    }
+    return heap->tie != NULL && heap->tie[a] < heap->tie[b];
+}
+
+GRAPH_API void siftUp(IndexedHeap *heap, int slot) {
+    int v = heap->items[slot];
+    while (slot > 0) {
+        int parent = (slot - 1) / HEAP_ARITY;
+        int p = heap->items[parent];
+        if (!heapBefore(heap, v, p)) {
+            break;
+        }
+        heap->items[slot] = p;
+        heap->position[p] = slot;
+        slot = parent;
+    }
+    heap->items[slot] = v;
+    heap->position[v] = slot;
+}
+
+GRAPH_API void siftDown(IndexedHeap *heap, int slot) {
+    int v = heap->items[slot];
+    for (;;) {
+        int first = slot * HEAP_ARITY + 1;
+        if (first >= heap->size) {
+            break;
+        }
+        int last = first + HEAP_ARITY < heap->size ? first + HEAP_ARITY : heap->size;
+        int best = first;
+        for (int child = first + 1; child < last; ++child) {
+            if (heapBefore(heap, heap->items[child], heap->items[best])) {
+                best = child;
+            }
+        }
+        int c = heap->items[best];
+        if (!heapBefore(heap, c, v)) {
+            break;
+        }
+        heap->items[slot] = c;
+        heap->position[c] = slot;
+        slot = best;
+    }
+    heap->items[slot] = v;
+    heap->position[v] = slot;
+}
+
+// Function to insert v, or lower its (key, tie) pair when it is already in the heap with a larger one
+GRAPH_API bool heapPushOrDecreaseTie(IndexedHeap *heap, int v, int64_t key, int64_t tie) {
+    if (heap->position[v] < 0) {
+        heap->key[v] = key;
+        if (heap->tie != NULL) {
+            heap->tie[v] = tie;
+        }
+        heap->items[heap->size] = v;
+        heap->position[v] = heap->size;
+        heap->size++;
+        siftUp(heap, heap->size - 1);
+        STAT_INC(heap->pushes);
+        return true;
+    }
+    if (key < heap->key[v] || (key == heap->key[v] && heap->tie != NULL && tie < heap->tie[v])) {
+        heap->key[v] = key;
+        if (heap->tie != NULL) {
+            heap->tie[v] = tie;
+        }
+        siftUp(heap, heap->position[v]);
+        STAT_INC(heap->decreases);
+        return true;
+    }
+    return false;
+}
+
+// Function to insert v, or lower its key when it is already in the heap with a larger one
+GRAPH_API bool heapPushOrDecrease(IndexedHeap *heap, int v, int64_t key) {
+    return heapPushOrDecreaseTie(heap, v, key, 0);
+}
+
+// Function to remove and return the vertex with the smallest key
+GRAPH_API int heapPop(IndexedHeap *heap) {
+    int top = heap->items[0];
+    heap->position[top] = -1;
+    STAT_INC(heap->pops);
+    heap->size--;
+    if (heap->size > 0) {
+        heap->items[0] = heap->items[heap->size];
+        siftDown(heap, 0);
+    }
+    return top;
+}
+
+// Function to move the operation counts of the heap into the statistics
+GRAPH_API void publishHeapStats(IndexedHeap *heap) {
+    statAdd(STAT_HEAP_PUSHES, heap->pushes);
+    statAdd(STAT_HEAP_DECREASES, heap->decreases);
+    statAdd(STAT_HEAP_POPS, heap->pops);
+    heap->pushes = heap->decreases = heap->pops = 0;
+}
+
+#endif // HEAP_H
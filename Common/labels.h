@@ -0,0 +1,203 @@
+/**
+ * @file labels.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Vertex names of any length, interned through a compact open-addressing hash table.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * The algorithms only ever see vertex ids. Names are looked at while a file is parsed, when a
+ * vertex given on the command line is looked up, and when results are printed. All names sit
+ * back to back in one text buffer, each NUL-terminated and preceded by its vertex as 4 bytes,
+ * and start[v] tells where the name of v begins. The index is a power-of-two array kept at
+ * most half full and probed linearly. Each slot packs 24 bits of the hash of a name with the
+ * position of the name in the text, so a lookup touches the slot and then the text around the
+ * name, which holds the vertex too: two cache misses where going through start[] would take
+ * three, and interning millions of names is bound by those misses. A table costs its text plus
+ * 28 to 44 bytes per vertex, with no limit on the length of a name or on the number of names.
+ */
+#ifndef LABELS_H
+#define LABELS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define LABEL_EMPTY UINT64_MAX
+#define LABEL_OFFSET_BITS 40   // Text positions up to 1 TB
+#define LABEL_OFFSET_MASK (((uint64_t)1 << LABEL_OFFSET_BITS) - 1)
+
+typedef struct LabelTable {
+    int count;
+    int longest;               // Length of the longest name
+    int64_t *start;            // count + 1 entries: the name of v is text + start[v]
+    char *text;                // Each name is preceded by its vertex and followed by a NUL
+    uint64_t *slots;           // slotCount entries: top 24 bits of the hash | name position, or LABEL_EMPTY
+    int64_t slotCount;         // A power of two
+    int capacity;              // Names start can hold; 0 once the table is frozen
+    int64_t textCapacity;
+} LabelTable;
+
+GRAPH_API void initLabels(LabelTable *labels) {
+    labels->count = 0;
+    labels->longest = 0;
+    labels->capacity = 16;
+    labels->textCapacity = 256;
+    labels->start = (int64_t *)xmalloc((labels->capacity + 1) * sizeof(int64_t));
+    labels->text = (char *)xmalloc(labels->textCapacity);
+    labels->slotCount = 32;
+    labels->slots = (uint64_t *)xmalloc(labels->slotCount * sizeof(uint64_t));
+    memset(labels->slots, 0xff, labels->slotCount * sizeof(uint64_t));
+    labels->start[0] = sizeof(int32_t);
+}
+
+// Function to release a table built with initLabels (not one copied into an arena)
+GRAPH_API void freeLabels(LabelTable *labels) {
+    free(labels->start);
+    free(labels->text);
+    free(labels->slots);
+}
+
+// Function to hash a name (FNV-1a)
+GRAPH_API uint32_t labelHash(const char *name, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+GRAPH_API const char *labelName(const LabelTable *labels, int v) {
+    return labels->text + labels->start[v];
+}
+
+// Function to return the length of the name of v, without looking at the name
+GRAPH_API size_t labelLength(const LabelTable *labels, int v) {
+    return labels->start[v + 1] - labels->start[v] - 1 - sizeof(int32_t);
+}
+
+// Function to return the bytes of text in use (start[count] is where a next name would begin)
+GRAPH_API int64_t labelTextSize(const LabelTable *labels) {
+    return labels->start[labels->count] - (int64_t)sizeof(int32_t);
+}
+
+// Function to find the vertex with the given name; -1 when there is none
+GRAPH_API int findLabel(const LabelTable *labels, const char *name, size_t length) {
+    uint32_t hash = labelHash(name, length);
+    uint64_t tag = (uint64_t)(hash >> 8) << LABEL_OFFSET_BITS;
+    uint64_t textSize = (uint64_t)labelTextSize(labels);
+    int64_t mask = labels->slotCount - 1;
+    for (int64_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        uint64_t entry = labels->slots[slot];
+        if (entry == LABEL_EMPTY) {
+            return -1;
+        }
+        uint64_t at = entry & LABEL_OFFSET_MASK;
+        if ((entry & ~LABEL_OFFSET_MASK) == tag && at >= sizeof(int32_t) && at + length < textSize &&
+            memcmp(labels->text + at, name, length) == 0 && labels->text[at + length] == '\0') {
+            int32_t v;
+            memcpy(&v, labels->text + at - sizeof(int32_t), sizeof(int32_t));
+            return v;
+        }
+    }
+}
+
+// Function to put the name at position 'at' of the text in the first free slot of its probe sequence
+GRAPH_API void indexLabel(LabelTable *labels, uint64_t at, uint32_t hash) {
+    int64_t mask = labels->slotCount - 1;
+    int64_t slot = hash & mask;
+    while (labels->slots[slot] != LABEL_EMPTY) {
+        slot = (slot + 1) & mask;
+    }
+    labels->slots[slot] = (uint64_t)(hash >> 8) << LABEL_OFFSET_BITS | at;
+}
+
+// Function to name the next vertex, even if another vertex already has that name (lookups then
+// find the first one); returns the new vertex
+GRAPH_API int appendLabel(LabelTable *labels, const char *name, size_t length) {
+    if (labels->count == INT32_MAX - 1) {
+        printf("Too many vertex names.\n");
+        exit(1);
+    }
+    if (labels->count == labels->capacity) {
+        labels->capacity *= 2;
+        labels->start = (int64_t *)xrealloc(labels->start, (labels->capacity + 1) * sizeof(int64_t));
+    }
+    int64_t at = labels->start[labels->count];
+    int64_t next = at + (int64_t)length + 1 + sizeof(int32_t);
+    if ((uint64_t)next > LABEL_OFFSET_MASK) {
+        printf("Vertex names too long.\n");
+        exit(1);
+    }
+    while (next > labels->textCapacity) {
+        labels->textCapacity *= 2;
+        labels->text = (char *)xrealloc(labels->text, labels->textCapacity);
+    }
+    int32_t v = labels->count++;
+    memcpy(labels->text + at - sizeof(int32_t), &v, sizeof(int32_t));
+    memcpy(labels->text + at, name, length);
+    labels->text[at + length] = '\0';
+    labels->start[v + 1] = next;
+    labels->longest = (int)length > labels->longest ? (int)length : labels->longest;
+
+    if (2 * (int64_t)labels->count > labels->slotCount) {
+        // The slots keep only part of each hash, so growing hashes the names again, in text order
+        labels->slotCount *= 2;
+        free(labels->slots);
+        labels->slots = (uint64_t *)xmalloc(labels->slotCount * sizeof(uint64_t));
+        memset(labels->slots, 0xff, labels->slotCount * sizeof(uint64_t));
+        for (int u = 0; u < labels->count; ++u) {
+            indexLabel(labels, labels->start[u], labelHash(labelName(labels, u), labelLength(labels, u)));
+        }
+    } else {
+        indexLabel(labels, at, labelHash(name, length));
+    }
+    return v;
+}
+
+// Function to return the vertex with the given name, naming a new vertex the first time
+GRAPH_API int internLabel(LabelTable *labels, const char *name, size_t length) {
+    int v = findLabel(labels, name, length);
+    return v >= 0 ? v : appendLabel(labels, name, length);
+}
+
+// Function to copy a table into an arena, trimmed to its size; the copy cannot grow
+GRAPH_API LabelTable *copyLabels(const LabelTable *labels, Arena *arena) {
+    LabelTable *copy = (LabelTable *)arenaAlloc(arena, sizeof(LabelTable));
+    int64_t textSize = labelTextSize(labels);
+    copy->count = labels->count;
+    copy->longest = labels->longest;
+    copy->start = (int64_t *)arenaAlloc(arena, (labels->count + 1) * sizeof(int64_t));
+    copy->text = (char *)arenaAlloc(arena, textSize);
+    copy->slots = (uint64_t *)arenaAlloc(arena, labels->slotCount * sizeof(uint64_t));
+    copy->slotCount = labels->slotCount;
+    copy->capacity = 0;
+    copy->textCapacity = 0;
+    memcpy(copy->start, labels->start, (labels->count + 1) * sizeof(int64_t));
+    memcpy(copy->text, labels->text, textSize);
+    memcpy(copy->slots, labels->slots, labels->slotCount * sizeof(uint64_t));
+    return copy;
+}
+
+// Function to print the label line of a graph with V vertices; single-character names are
+// run together, as the label line of the original matrix files was printed
+GRAPH_API void printLabelLine(const LabelTable *labels, int V) {
+    if (labels == NULL) {
+        printf("Vertex labels: none, vertices numbered 0 to %d\n", V - 1);
+        return;
+    }
+    printf("Vertex labels: ");
+    for (int v = 0; v < labels->count; ++v) {
+        if (v > 0 && labels->longest > 1) {
+            putchar(' ');
+        }
+        fputs(labelName(labels, v), stdout);
+    }
+    putchar('\n');
+}
+
+#endif // LABELS_H
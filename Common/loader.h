@@ -0,0 +1,387 @@
+/**
+ * @file loader.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Readers for the input formats accepted by every tool.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Supported formats:
+ *  - label matrix: a line of vertex labels followed by a V x V weight matrix (the original format);
+ *  - edge list (.el, .edges, .edgelist or a leading '#' comment): "src dst [weight]" per line,
+ *    with 0-based ids, or with vertex names of any length when the first id is not a number;
+ *  - DIMACS shortest path (.gr or a "p sp" line): "p sp V E" then "a src dst weight", 1-based;
+ *  - Matrix Market coordinate (.mtx or a "%%MatrixMarket" header), 1-based.
+ * Only the matrix format costs O(V^2); the others are read in O(V + E). Files are
+ * memory-mapped and tokenized by scanner.h instead of going through fscanf. Binary
+ * snapshots (snapshot.h) are recognised by their magic and mapped without any parsing.
+ *
+ * The readers hand every edge to an EdgeSink as soon as it is parsed. createGraph collects
+ * them in a GraphBuilder; streamEdges lets a tool consume them without ever storing them.
+ */
+#ifndef LOADER_H
+#define LOADER_H
+
+#include "graph.h"
+#include "scanner.h"
+#include "snapshot.h"
+
+typedef enum GraphFormat {
+    FORMAT_MATRIX,
+    FORMAT_EDGE_LIST,
+    FORMAT_DIMACS,
+    FORMAT_MATRIX_MARKET
+} GraphFormat;
+
+// Receiver of the edges of a file, called in file order while the file is parsed
+typedef struct EdgeSink {
+    void (*edge)(void *context, int src, int dest, int weight);
+    void *context;
+} EdgeSink;
+
+GRAPH_API void builderEdge(void *context, int src, int dest, int weight) {
+    addEdge((GraphBuilder *)context, src, dest, weight);
+}
+
+// Function to check whether the file name ends with the given extension
+GRAPH_API bool hasExtension(const char *fileName, const char *extension) {
+    size_t n = strlen(fileName);
+    size_t m = strlen(extension);
+    return n >= m && strcmp(fileName + n - m, extension) == 0;
+}
+
+// Function to guess the format from the extension, then from the first lines of the file
+GRAPH_API GraphFormat detectFormat(Scanner *scanner) {
+    if (hasExtension(scanner->fileName, ".gr")) {
+        return FORMAT_DIMACS;
+    }
+    if (hasExtension(scanner->fileName, ".mtx")) {
+        return FORMAT_MATRIX_MARKET;
+    }
+    if (hasExtension(scanner->fileName, ".el") || hasExtension(scanner->fileName, ".edges") ||
+        hasExtension(scanner->fileName, ".edgelist")) {
+        return FORMAT_EDGE_LIST;
+    }
+
+    GraphFormat format = FORMAT_MATRIX;
+    if (startsWith(scanner, "%%MatrixMarket")) {
+        format = FORMAT_MATRIX_MARKET;
+    } else if (startsWith(scanner, "#")) {
+        format = FORMAT_EDGE_LIST;
+    } else {
+        // DIMACS files open with "c" comment lines and a "p sp V E" problem line
+        while (startsWith(scanner, "c ") || startsWith(scanner, "c\n") || startsWith(scanner, "c\r")) {
+            skipLine(scanner);
+        }
+        if (startsWith(scanner, "p sp ")) {
+            format = FORMAT_DIMACS;
+        }
+    }
+    scanner->cur = scanner->data;
+    return format;
+}
+
+// Function to count the blank-separated words in [p, end)
+GRAPH_API int64_t countWords(const char *p, const char *end) {
+    int64_t words = 0;
+    for (bool inWord = false; p < end; ++p) {
+        words += !inWord && !isBlank(*p) && *p != '\n';
+        inWord = !isBlank(*p) && *p != '\n';
+    }
+    return words;
+}
+
+// Function to find the end of the line that starts at p
+GRAPH_API const char *lineEndOf(const Scanner *scanner, const char *p) {
+    const char *newline = (const char *)memchr(p, '\n', scanner->end - p);
+    return newline != NULL ? newline : scanner->end;
+}
+
+// Function to read the original format: a label line and a V x V weight matrix; returns V.
+// The names are the words of the first line. A line of one word, such as "ABCD", names one
+// vertex per character when the first row of the matrix has that many cells.
+GRAPH_API int readMatrixEdges(Scanner *scanner, EdgeSink *sink, LabelTable *labels) {
+    const char *lineEnd = lineEndOf(scanner, scanner->cur);
+    int64_t words = countWords(scanner->cur, lineEnd);
+    if (words == 0) {
+        scannerError(scanner, "missing label line");
+    }
+    if (words >= INT32_MAX) {
+        scannerError(scanner, "too many labels");
+    }
+
+    const char *name;
+    size_t length = scanName(scanner, &name);
+    const char *rowStart = lineEnd < scanner->end ? lineEnd + 1 : lineEnd;
+    if (words == 1 && length > 1 && countWords(rowStart, lineEndOf(scanner, rowStart)) == (int64_t)length) {
+        for (size_t i = 0; i < length; ++i) {
+            appendLabel(labels, name + i, 1);
+        }
+    } else {
+        for (; length > 0; length = scanName(scanner, &name)) {
+            appendLabel(labels, name, length);
+        }
+    }
+    int V = labels->count;
+    scanner->cur = lineEnd;
+
+    // Every non-zero cell becomes an edge carrying that weight
+    for (int i = 0; i < V; ++i) {
+        for (int j = 0; j < V; ++j) {
+            int weight = expectInt(scanner, true, "expected one weight per matrix cell");
+            if (weight != 0) {
+                sink->edge(sink->context, i, j, weight);
+            }
+        }
+        releaseParsed(scanner);
+    }
+    return V;
+}
+
+// Function to check whether the next word starts like a number
+GRAPH_API bool atNumber(const Scanner *scanner) {
+    const char *p = scanner->cur;
+    if (p < scanner->end && (*p == '-' || *p == '+')) {
+        ++p;
+    }
+    return p < scanner->end && isDigit(*p);
+}
+
+// Function to read "src dst [weight]" lines. Ids are 0-based numbers and the vertex count is
+// the largest one plus one, unless the first id of the file is not a number: then every id is
+// a name, and names are given vertex numbers in the order they first appear.
+GRAPH_API int readEdgeListEdges(Scanner *scanner, EdgeSink *sink, LabelTable *labels) {
+    int maxVertex = -1;
+    bool firstEdge = true;
+    bool named = false;
+    for (skipBlanks(scanner, true); !atEnd(scanner); skipBlanks(scanner, true)) {
+        char c = peekChar(scanner);
+        if (c == '#' || c == '%') {
+            skipLine(scanner);
+            continue;
+        }
+        if (firstEdge) {
+            named = !atNumber(scanner);
+            firstEdge = false;
+        }
+        if (named) {
+            const char *name;
+            size_t length = scanName(scanner, &name);
+            int src = internLabel(labels, name, length);
+            length = scanName(scanner, &name);
+            if (length == 0) {
+                scannerError(scanner, "expected \"src dst [weight]\"");
+            }
+            int dest = internLabel(labels, name, length);
+            int weight = atLineEnd(scanner) ? 1 : expectInt(scanner, false, "expected an integer weight");
+            sink->edge(sink->context, src, dest, weight);
+            skipLine(scanner);
+            releaseParsed(scanner);
+            continue;
+        }
+        int src = expectInt(scanner, false, "expected \"src dst [weight]\"");
+        int dest = expectInt(scanner, false, "expected \"src dst [weight]\"");
+        int weight = atLineEnd(scanner) ? 1 : expectInt(scanner, false, "expected an integer weight");
+        if (src < 0 || dest < 0 || src == INT32_MAX || dest == INT32_MAX) {
+            scannerError(scanner, "vertex ids must be non-negative");
+        }
+        sink->edge(sink->context, src, dest, weight);
+        maxVertex = src > maxVertex ? src : maxVertex;
+        maxVertex = dest > maxVertex ? dest : maxVertex;
+        skipLine(scanner); // Extra columns, such as timestamps, are ignored
+        releaseParsed(scanner);
+    }
+    return named ? labels->count : maxVertex + 1;
+}
+
+// Function to read a DIMACS shortest path file ("p sp V E" and "a src dst weight" lines)
+GRAPH_API int readDimacsEdges(Scanner *scanner, EdgeSink *sink) {
+    int V = -1;
+
+    char word[8];
+    for (skipBlanks(scanner, true); !atEnd(scanner); skipBlanks(scanner, true)) {
+        char c = peekChar(scanner);
+        if (c == 'p') {
+            ++scanner->cur;
+            if (!scanWord(scanner, word, sizeof(word)) || strcmp(word, "sp") != 0) {
+                scannerError(scanner, "expected \"p sp V E\"");
+            }
+            V = expectInt(scanner, false, "expected \"p sp V E\"");
+            if (V < 0) {
+                scannerError(scanner, "expected \"p sp V E\"");
+            }
+        } else if (c == 'a') {
+            ++scanner->cur;
+            if (V < 0) {
+                scannerError(scanner, "arc before the \"p sp\" line");
+            }
+            int src = expectInt(scanner, false, "expected \"a src dst weight\"");
+            int dest = expectInt(scanner, false, "expected \"a src dst weight\"");
+            int weight = expectInt(scanner, false, "expected \"a src dst weight\"");
+            if (src < 1 || dest < 1 || src > V || dest > V) {
+                scannerError(scanner, "arc ids must be between 1 and V");
+            }
+            sink->edge(sink->context, src - 1, dest - 1, weight);
+        }
+        skipLine(scanner);
+        releaseParsed(scanner);
+    }
+
+    if (V < 0) {
+        scannerError(scanner, "missing \"p sp\" line");
+    }
+    return V;
+}
+
+// Function to read a Matrix Market coordinate file
+GRAPH_API int readMatrixMarketEdges(Scanner *scanner, EdgeSink *sink) {
+    char object[32], layout[32], field[32], symmetry[32];
+    scanner->cur += strlen("%%MatrixMarket");
+    if (!scanWord(scanner, object, sizeof(object)) || !scanWord(scanner, layout, sizeof(layout)) ||
+        !scanWord(scanner, field, sizeof(field)) || !scanWord(scanner, symmetry, sizeof(symmetry))) {
+        scannerError(scanner, "malformed %%MatrixMarket header");
+    }
+    if (strcmp(layout, "coordinate") != 0) {
+        scannerError(scanner, "only the coordinate layout is supported");
+    }
+    bool pattern = strcmp(field, "pattern") == 0;
+    bool symmetric = strcmp(symmetry, "symmetric") == 0 || strcmp(symmetry, "hermitian") == 0;
+    bool skew = strcmp(symmetry, "skew-symmetric") == 0;
+    skipLine(scanner);
+
+    // Skip comments up to the "rows cols entries" line
+    for (skipBlanks(scanner, true); peekChar(scanner) == '%'; skipBlanks(scanner, true)) {
+        skipLine(scanner);
+    }
+    int rows = expectInt(scanner, false, "expected \"rows cols entries\"");
+    int cols = expectInt(scanner, false, "expected \"rows cols entries\"");
+    int64_t entries;
+    if (rows < 0 || cols < 0 || !scanInt64(scanner, &entries, false) || entries < 0) {
+        scannerError(scanner, "expected \"rows cols entries\"");
+    }
+
+    for (int64_t read = 0; read < entries; ++read) {
+        for (skipBlanks(scanner, true); peekChar(scanner) == '%'; skipBlanks(scanner, true)) {
+            skipLine(scanner);
+        }
+        if (atEnd(scanner)) {
+            scannerError(scanner, "fewer entries than announced");
+        }
+        int src = expectInt(scanner, false, "expected \"row col [value]\"");
+        int dest = expectInt(scanner, false, "expected \"row col [value]\"");
+        double value = 1.0;
+        if (!pattern && !scanReal(scanner, &value, false)) {
+            scannerError(scanner, "expected \"row col value\"");
+        }
+        if (src < 1 || dest < 1 || src > rows || dest > cols) {
+            scannerError(scanner, "entry outside the matrix");
+        }
+        // Rounds to at most INT_MAX either way, so a skew entry can be negated too; NaN fails both tests
+        if (!(value > -(double)INT_MAX - 0.5 && value < (double)INT_MAX + 0.5)) {
+            scannerError(scanner, "weight out of range");
+        }
+        int weight = (int)(value < 0 ? value - 0.5 : value + 0.5);
+        sink->edge(sink->context, src - 1, dest - 1, weight);
+        if ((symmetric || skew) && src != dest) {
+            sink->edge(sink->context, dest - 1, src - 1, skew ? -weight : weight);
+        }
+        skipLine(scanner);
+        releaseParsed(scanner);
+    }
+    return rows > cols ? rows : cols;
+}
+
+// Function to feed every edge of a file to the sink, returning the vertex count. The vertex
+// names go to *labels, which this function initialises and which stays empty when the file
+// has none; they are dropped when labels is NULL. Only the sink and the names are kept: a
+// streaming scanner holds no more than 64 MB of the file.
+GRAPH_API int streamEdges(const char *fileName, EdgeSink *sink, LabelTable *labels) {
+    statInput(fileName);
+    statPhase(PHASE_PARSE);
+    LabelTable names;
+    initLabels(&names);
+    int V = 0;
+    if (isSnapshotFile(fileName)) {
+        Graph *graph = loadSnapshot(fileName);
+        for (int u = 0; u < graph->V; ++u) {
+            for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; ++e) {
+                sink->edge(sink->context, u, graph->dest[e], graph->weight[e]);
+            }
+        }
+        V = graph->V;
+        for (int v = 0; graph->labels != NULL && v < graph->labels->count; ++v) {
+            const char *name = labelName(graph->labels, v);
+            appendLabel(&names, name, strlen(name));
+        }
+        freeGraph(graph);
+    } else {
+        Scanner scanner;
+        mapScanner(&scanner, fileName, true);
+        switch (detectFormat(&scanner)) {
+        case FORMAT_MATRIX:
+            V = readMatrixEdges(&scanner, sink, &names);
+            break;
+        case FORMAT_EDGE_LIST:
+            V = readEdgeListEdges(&scanner, sink, &names);
+            break;
+        case FORMAT_DIMACS:
+            V = readDimacsEdges(&scanner, sink);
+            break;
+        case FORMAT_MATRIX_MARKET:
+            V = readMatrixMarketEdges(&scanner, sink);
+            break;
+        }
+        closeScanner(&scanner);
+    }
+    if (labels != NULL) {
+        *labels = names;
+    } else {
+        freeLabels(&names);
+    }
+    return V;
+}
+
+// Function to create a graph from a file in any of the supported formats; the file is read
+// through a streaming scanner, so the parsed part of it is dropped while the edges pile up
+GRAPH_API Graph *createGraph(const char *fileName) {
+    statInput(fileName);
+    statPhase(PHASE_PARSE);
+    if (isSnapshotFile(fileName)) {
+        return loadSnapshot(fileName);
+    }
+
+    Scanner scanner;
+    mapScanner(&scanner, fileName, true);
+
+    GraphBuilder builder;
+    initGraphBuilder(&builder, 0);
+    EdgeSink sink = {builderEdge, &builder};
+    LabelTable labels;
+    initLabels(&labels);
+    switch (detectFormat(&scanner)) {
+    case FORMAT_MATRIX:
+        builder.V = readMatrixEdges(&scanner, &sink, &labels);
+        break;
+    case FORMAT_EDGE_LIST:
+        builder.V = readEdgeListEdges(&scanner, &sink, &labels);
+        break;
+    case FORMAT_DIMACS:
+        builder.V = readDimacsEdges(&scanner, &sink);
+        break;
+    case FORMAT_MATRIX_MARKET:
+        builder.V = readMatrixMarketEdges(&scanner, &sink);
+        break;
+    }
+
+    closeScanner(&scanner);
+    statAdd(STAT_EDGES_READ, builder.count);
+    statPhase(PHASE_BUILD);
+    if (labels.count == 0) {
+        freeLabels(&labels);
+        return buildGraph(&builder, NULL);
+    }
+    return buildGraph(&builder, &labels);
+}
+
+#endif // LOADER_H
@@ -0,0 +1,166 @@
+/**
+ * @file output.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Buffered result output as human-readable text, CSV or raw binary arrays.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Printing one line per vertex with printf costs more than computing the result once the
+ * graph has millions of vertices: every call parses its format string, and every value goes
+ * through the locale-aware number formatting. The printers of the tools write into one
+ * OUTPUT_BUFFER_SIZE buffer instead, turn numbers into digits two at a time, and hand the
+ * buffer to stdout with a single fwrite when it fills or when they are done, so anything
+ * printed with printf before or after keeps its place. Tools take --output=text|csv|binary
+ * through outputOption; binary output is the result arrays in native byte order, with
+ * nothing around them, for programs to read back.
+ */
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+typedef enum OutputFormat {
+    OUTPUT_TEXT,
+    OUTPUT_CSV,
+    OUTPUT_BINARY
+} OutputFormat;
+
+typedef struct Output {
+    OutputFormat format;
+    char *buffer;              // Allocated by the first write
+    size_t used;
+} Output;
+
+static Output graphOutput;
+
+static const char outputDigitPairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Function to take --output=text|csv|binary from the command line; returns false for any other
+// argument
+GRAPH_API bool outputOption(const char *arg) {
+    if (strncmp(arg, "--output=", 9) != 0) {
+        return false;
+    }
+    const char *name = arg + 9;
+    if (strcmp(name, "text") == 0) {
+        graphOutput.format = OUTPUT_TEXT;
+    } else if (strcmp(name, "csv") == 0) {
+        graphOutput.format = OUTPUT_CSV;
+    } else if (strcmp(name, "binary") == 0) {
+        if (isatty(STDOUT_FILENO)) {
+            printf("Binary output goes to a file or a pipe, not to a terminal.\n");
+            exit(1);
+        }
+        graphOutput.format = OUTPUT_BINARY;
+    } else {
+        printf("Unknown output format %s: use text, csv or binary.\n", name);
+        exit(1);
+    }
+    return true;
+}
+
+GRAPH_API OutputFormat outputFormat(void) {
+    return graphOutput.format;
+}
+
+// Function to hand what is buffered to stdout
+GRAPH_API void outputFlush(void) {
+    if (graphOutput.used > 0) {
+        fwrite(graphOutput.buffer, 1, graphOutput.used, stdout);
+        graphOutput.used = 0;
+    }
+    fflush(stdout);
+}
+
+// Function to make room for size more bytes, returning where they go
+GRAPH_API char *outputReserve(size_t size) {
+    if (graphOutput.buffer == NULL) {
+        graphOutput.buffer = (char *)xmalloc(OUTPUT_BUFFER_SIZE);
+    }
+    if (graphOutput.used + size > OUTPUT_BUFFER_SIZE) {
+        fwrite(graphOutput.buffer, 1, graphOutput.used, stdout);
+        graphOutput.used = 0;
+    }
+    return graphOutput.buffer + graphOutput.used;
+}
+
+GRAPH_API void outputBytes(const void *data, size_t size) {
+    if (size > OUTPUT_BUFFER_SIZE / 2) {
+        // Large arrays skip the buffer, after what is already in it
+        outputReserve(OUTPUT_BUFFER_SIZE);
+        fwrite(data, 1, size, stdout);
+        return;
+    }
+    memcpy(outputReserve(size), data, size);
+    graphOutput.used += size;
+}
+
+GRAPH_API void outputText(const char *text) {
+    outputBytes(text, strlen(text));
+}
+
+GRAPH_API void outputChar(char c) {
+    *outputReserve(1) = c;
+    graphOutput.used++;
+}
+
+// Function to write a number in decimal into 'to', which needs room for 20 characters;
+// returns the length
+GRAPH_API int formatInt(char *to, int64_t value) {
+    char digits[20];
+    int n = 0;
+    uint64_t rest = value < 0 ? -(uint64_t)value : (uint64_t)value;
+    while (rest >= 100) {
+        n += 2;
+        memcpy(digits + sizeof(digits) - n, outputDigitPairs + 2 * (rest % 100), 2);
+        rest /= 100;
+    }
+    if (rest >= 10) {
+        n += 2;
+        memcpy(digits + sizeof(digits) - n, outputDigitPairs + 2 * rest, 2);
+    } else {
+        digits[sizeof(digits) - ++n] = (char)('0' + rest);
+    }
+    int length = 0;
+    if (value < 0) {
+        to[length++] = '-';
+    }
+    memcpy(to + length, digits + sizeof(digits) - n, n);
+    return length + n;
+}
+
+GRAPH_API void outputInt(int64_t value) {
+    graphOutput.used += formatInt(outputReserve(20), value);
+}
+
+// Function to write a text as one CSV field, quoted when it holds a comma or a quote
+GRAPH_API void outputCsvField(const char *text) {
+    if (strpbrk(text, ",\"") == NULL) {
+        outputText(text);
+        return;
+    }
+    outputChar('"');
+    for (const char *p = text; *p != '\0'; ++p) {
+        if (*p == '"') {
+            outputChar('"');
+        }
+        outputChar(*p);
+    }
+    outputChar('"');
+}
+
+#endif // OUTPUT_H
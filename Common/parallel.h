@@ -0,0 +1,122 @@
+/**
+ * @file parallel.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Minimal fork-join helpers on top of POSIX threads (build with -pthread).
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "graph.h"
+
+typedef void (*ParallelTask)(void *context, int thread, int threads);
+
+typedef struct ParallelWorker {
+    ParallelTask task;
+    void *context;
+    int thread;
+    int threads;
+} ParallelWorker;
+
+// Function to count the online cores, used when the user does not pick a thread count
+GRAPH_API int defaultThreadCount(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+GRAPH_API void *parallelEntry(void *argument) {
+    ParallelWorker *worker = (ParallelWorker *)argument;
+    worker->task(worker->context, worker->thread, worker->threads);
+    return NULL;
+}
+
+// Function to run task(context, t, threads) for t = 0 .. threads - 1 and wait for all of them
+GRAPH_API void parallelRun(int threads, ParallelTask task, void *context) {
+    if (threads <= 1) {
+        task(context, 0, 1);
+        return;
+    }
+    pthread_t *ids = (pthread_t *)xmalloc(threads * sizeof(pthread_t));
+    ParallelWorker *workers = (ParallelWorker *)xmalloc(threads * sizeof(ParallelWorker));
+    for (int t = 0; t < threads; ++t) {
+        workers[t].task = task;
+        workers[t].context = context;
+        workers[t].thread = t;
+        workers[t].threads = threads;
+        if (t > 0 && pthread_create(&ids[t], NULL, parallelEntry, &workers[t]) != 0) {
+            printf("Error creating a thread.\n");
+            exit(1);
+        }
+    }
+    task(context, 0, threads); // The calling thread does the first share
+    for (int t = 1; t < threads; ++t) {
+        pthread_join(ids[t], NULL);
+    }
+    free(workers);
+    free(ids);
+}
+
+// Function to split [0, n) into equal contiguous blocks, returning the block of this thread
+GRAPH_API void parallelBlock(int64_t n, int thread, int threads, int64_t *begin, int64_t *end) {
+    *begin = n * thread / threads;
+    *end = n * (thread + 1) / threads;
+}
+
+// One deque of task indices per thread: the owner works from the front in task order,
+// thieves take from the back the tasks the owner would reach last
+typedef struct TaskDeque {
+    pthread_mutex_t lock;
+    int64_t head;
+    int64_t tail;
+} TaskDeque;
+
+typedef struct WorkStealing {
+    int threads;
+    TaskDeque *deques;
+} WorkStealing;
+
+// Function to deal tasks 0 .. tasks - 1 out to the threads in contiguous blocks
+GRAPH_API void initWorkStealing(WorkStealing *ws, int64_t tasks, int threads) {
+    ws->threads = threads;
+    ws->deques = (TaskDeque *)xmalloc(threads * sizeof(TaskDeque));
+    for (int t = 0; t < threads; ++t) {
+        pthread_mutex_init(&ws->deques[t].lock, NULL);
+        parallelBlock(tasks, t, threads, &ws->deques[t].head, &ws->deques[t].tail);
+    }
+}
+
+GRAPH_API void freeWorkStealing(WorkStealing *ws) {
+    for (int t = 0; t < ws->threads; ++t) {
+        pthread_mutex_destroy(&ws->deques[t].lock);
+    }
+    free(ws->deques);
+}
+
+// Function to get the next task of a thread, stealing the last task of another thread
+// when its own deque is empty; false once every deque is empty
+GRAPH_API bool takeTask(WorkStealing *ws, int thread, int64_t *task) {
+    for (int i = 0; i < ws->threads; ++i) {
+        int victim = (thread + i) % ws->threads;
+        TaskDeque *deque = &ws->deques[victim];
+        pthread_mutex_lock(&deque->lock);
+        bool taken = deque->head < deque->tail;
+        if (taken) {
+            *task = victim == thread ? deque->head++ : --deque->tail;
+        }
+        pthread_mutex_unlock(&deque->lock);
+        if (taken) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,313 @@
+/**
+ * @file scanner.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Tokenizer that reads a memory-mapped file without stdio and without allocating.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Whitespace runs are classified 16 bytes at a time with SSE2 when it is available, and
+ * digits are classified and converted eight at a time inside a 64-bit word (SWAR), with no
+ * branch per character. The last bytes of the file always go through the scalar path, so
+ * nothing is ever read past the end of the mapping. A scanner opened for streaming does not
+ * prefault the file and drops the pages it has parsed, so its footprint stays bounded
+ * whatever the file size.
+ */
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE 0
+#endif
+
+#define SCANNER_RELEASE_BYTES ((size_t)64 << 20)
+
+#include "graph.h"
+
+typedef struct Scanner {
+    const char *fileName;
+    const char *data;
+    const char *cur;
+    const char *end;
+    const char *released;      // Parsed pages before this point were given back to the kernel
+    bool streaming;
+    size_t size;
+} Scanner;
+
+// Function to map a whole file for reading; a streaming scanner reads it in as it goes
+GRAPH_API void mapScanner(Scanner *scanner, const char *fileName, bool streaming) {
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        printf("Error opening the file.\n");
+        exit(1);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        printf("Error opening the file.\n");
+        exit(1);
+    }
+
+    scanner->fileName = fileName;
+    scanner->size = (size_t)info.st_size;
+    scanner->data = "";
+    if (scanner->size > 0) {
+        void *map = mmap(NULL, scanner->size, PROT_READ, MAP_PRIVATE | (streaming ? 0 : MAP_POPULATE), fd, 0);
+        if (map == MAP_FAILED) {
+            printf("Error mapping the file.\n");
+            exit(1);
+        }
+        madvise(map, scanner->size, MADV_SEQUENTIAL);
+        scanner->data = (const char *)map;
+    }
+    close(fd);
+    scanner->cur = scanner->released = scanner->data;
+    scanner->end = scanner->data + scanner->size;
+    scanner->streaming = streaming;
+}
+
+GRAPH_API void openScanner(Scanner *scanner, const char *fileName) {
+    mapScanner(scanner, fileName, false);
+}
+
+// Function to drop the parsed part of a streaming scanner's file from memory, every 64 MB;
+// the pages come back from the file if an error message has to count lines
+GRAPH_API void releaseParsed(Scanner *scanner) {
+    if (!scanner->streaming || (size_t)(scanner->cur - scanner->released) < SCANNER_RELEASE_BYTES) {
+        return;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const char *upTo = scanner->data + (size_t)(scanner->cur - scanner->data) / page * page;
+    madvise((void *)scanner->released, upTo - scanner->released, MADV_DONTNEED);
+    scanner->released = upTo;
+}
+
+GRAPH_API void closeScanner(Scanner *scanner) {
+    if (scanner->size > 0) {
+        munmap((void *)scanner->data, scanner->size);
+    }
+    scanner->data = scanner->cur = scanner->end = scanner->released = NULL;
+    scanner->size = 0;
+}
+
+// Function to report a parse error with the line it happened on
+GRAPH_API void scannerError(const Scanner *scanner, const char *message) {
+    long line = 1;
+    for (const char *p = scanner->data; p < scanner->cur && p < scanner->end; ++p) {
+        line += *p == '\n';
+    }
+    printf("Error reading %s, line %ld: %s\n", scanner->fileName, line, message);
+    exit(1);
+}
+
+GRAPH_API bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+GRAPH_API bool isDigit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+#ifdef __SSE2__
+// Bit i is set when byte i of the block is ' ', '\t' or '\r' (and '\n' when newlines count)
+GRAPH_API unsigned blankMask(__m128i block, bool newlines) {
+    __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')),
+                                 _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\t')),
+                                              _mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))));
+    __m128i newline = _mm_and_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')),
+                                    _mm_set1_epi8(newlines ? -1 : 0));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(blank, newline));
+}
+
+// Bit i is set when byte i of the block is an ASCII digit
+GRAPH_API unsigned digitMask(__m128i block) {
+    __m128i low = _mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1));
+    __m128i high = _mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1));
+    return (unsigned)_mm_movemask_epi8(_mm_and_si128(low, high));
+}
+#endif
+
+// Function to skip spaces, tabs and carriage returns, and newlines too when asked
+GRAPH_API void skipBlanks(Scanner *scanner, bool newlines) {
+    const char *p = scanner->cur;
+    // Separators are usually a single byte, so only longer runs go to the vector loop
+    for (int i = 0; i < 4 && p < scanner->end; ++i, ++p) {
+        if (!isBlank(*p) && !(newlines && *p == '\n')) {
+            scanner->cur = p;
+            return;
+        }
+    }
+#ifdef __SSE2__
+    for (unsigned mask = 0xFFFF; mask == 0xFFFF && p + 16 <= scanner->end;) {
+        mask = blankMask(_mm_loadu_si128((const __m128i *)p), newlines);
+        p += mask == 0xFFFF ? 16 : __builtin_ctz(~mask);
+    }
+#endif
+    while (p < scanner->end && (isBlank(*p) || (newlines && *p == '\n'))) {
+        ++p;
+    }
+    scanner->cur = p;
+}
+
+GRAPH_API bool atEnd(Scanner *scanner) {
+    return scanner->cur >= scanner->end;
+}
+
+// Function to check, after skipping blanks, whether the current line has no more tokens
+GRAPH_API bool atLineEnd(Scanner *scanner) {
+    skipBlanks(scanner, false);
+    return scanner->cur >= scanner->end || *scanner->cur == '\n';
+}
+
+// Function to move past the end of the current line
+GRAPH_API void skipLine(Scanner *scanner) {
+    const char *newline = (const char *)memchr(scanner->cur, '\n', scanner->end - scanner->cur);
+    scanner->cur = newline ? newline + 1 : scanner->end;
+}
+
+// Function to return the next character without consuming it, or '\0' at the end of the file
+GRAPH_API char peekChar(Scanner *scanner) {
+    return scanner->cur < scanner->end ? *scanner->cur : '\0';
+}
+
+// Bit 8 * i + 7 is set when byte i of the word is not an ASCII digit (only exact up to the first such byte)
+GRAPH_API uint64_t nonDigitMask(uint64_t word) {
+    uint64_t nibbles = (word & 0xF0F0F0F0F0F0F0F0ULL) | (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4);
+    uint64_t diff = nibbles ^ 0x3333333333333333ULL;
+    return (((diff & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | diff) & 0x8080808080808080ULL;
+}
+
+// Function to convert the first count (1 to 8) digit characters of a word without branching
+GRAPH_API uint64_t digitsValue(uint64_t word, int count) {
+    uint64_t value = (word - 0x3030303030303030ULL) << (8 * (8 - count));
+    value = value * 10 + (value >> 8);
+    return (((value & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+            (((value >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+}
+
+// Function to read an optionally signed decimal integer; returns false when none is there
+GRAPH_API bool scanInt64(Scanner *scanner, int64_t *value, bool newlines) {
+    skipBlanks(scanner, newlines);
+    const char *p = scanner->cur;
+    bool negative = p < scanner->end && *p == '-';
+    p += p < scanner->end && (*p == '-' || *p == '+');
+
+    // Classify and convert eight bytes at a time while a whole word fits in the file
+    const char *digits = p;
+    uint64_t result = 0;
+    while (p + 8 <= scanner->end) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        uint64_t mask = nonDigitMask(word);
+        int count = mask ? __builtin_ctzll(mask) >> 3 : 8;
+        if (count == 0) {
+            break;
+        }
+        static const uint64_t powersOfTen[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+        result = result * powersOfTen[count] + digitsValue(word, count);
+        p += count;
+        if (count < 8) {
+            break;
+        }
+    }
+    for (; p < scanner->end && isDigit(*p) && p - digits <= 18; ++p) {
+        result = result * 10 + (*p - '0');
+    }
+    if (p == digits || p - digits > 18) {
+        return false;
+    }
+
+    *value = negative ? -(int64_t)result : (int64_t)result;
+    scanner->cur = p;
+    return true;
+}
+
+// Function to read an int, failing with the given message when it is missing or out of range
+GRAPH_API int expectInt(Scanner *scanner, bool newlines, const char *message) {
+    int64_t value;
+    if (!scanInt64(scanner, &value, newlines) || value < INT32_MIN || value > INT32_MAX) {
+        scannerError(scanner, message);
+    }
+    return (int)value;
+}
+
+// Function to read a decimal number such as "-1.5e3"; precise enough to round to an int weight
+GRAPH_API bool scanReal(Scanner *scanner, double *value, bool newlines) {
+    skipBlanks(scanner, newlines);
+    const char *p = scanner->cur;
+    bool negative = p < scanner->end && *p == '-';
+    p += p < scanner->end && (*p == '-' || *p == '+');
+
+    double result = 0;
+    bool any = false;
+    for (; p < scanner->end && isDigit(*p); ++p, any = true) {
+        result = result * 10 + (*p - '0');
+    }
+    if (p < scanner->end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < scanner->end && isDigit(*p); ++p, any = true) {
+            result += (*p - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+    if (!any) {
+        return false;
+    }
+    if (p < scanner->end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = p < scanner->end && *p == '-';
+        p += p < scanner->end && (*p == '-' || *p == '+');
+        int exponent = 0;
+        for (; p < scanner->end && isDigit(*p); ++p) {
+            exponent = exponent < 400 ? exponent * 10 + (*p - '0') : exponent;
+        }
+        for (; exponent > 0; --exponent) {
+            result = negativeExponent ? result / 10 : result * 10;
+        }
+    }
+    *value = negative ? -result : result;
+    scanner->cur = p;
+    return true;
+}
+
+// Function to copy the next blank-separated word of the line, lower-cased, into buffer
+GRAPH_API bool scanWord(Scanner *scanner, char *buffer, size_t size) {
+    skipBlanks(scanner, false);
+    size_t n = 0;
+    for (; scanner->cur < scanner->end && !isBlank(*scanner->cur) && *scanner->cur != '\n'; ++scanner->cur) {
+        if (n + 1 < size) {
+            char c = *scanner->cur;
+            buffer[n++] = c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+        }
+    }
+    buffer[n] = '\0';
+    return n > 0;
+}
+
+// Function to take the next blank-separated word of the line as it stands in the file, with
+// no copy and no length limit; returns its length, 0 when the line has no more words
+GRAPH_API size_t scanName(Scanner *scanner, const char **name) {
+    skipBlanks(scanner, false);
+    *name = scanner->cur;
+    while (scanner->cur < scanner->end && !isBlank(*scanner->cur) && *scanner->cur != '\n') {
+        ++scanner->cur;
+    }
+    return (size_t)(scanner->cur - *name);
+}
+
+// Function to check whether the rest of the file starts with the given text
+GRAPH_API bool startsWith(const Scanner *scanner, const char *text) {
+    size_t n = strlen(text);
+    return (size_t)(scanner->end - scanner->cur) >= n && memcmp(scanner->cur, text, n) == 0;
+}
+
+#endif // SCANNER_H
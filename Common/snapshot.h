@@ -0,0 +1,289 @@
+/**
+ * @file snapshot.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Binary graph snapshots that are memory-mapped and used in place, without parsing.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Layout (native byte order, every section aligned to SNAPSHOT_ALIGN bytes):
+ *   SnapshotHeader | offsets (int64 x V + 1) | dest (int32 x E) | weight (int32 x E)
+ *   | label starts (int64 x V + 1) | label text | label index (uint64 x slots)
+ * The header stores the byte position of each section, so later versions can add sections
+ * without moving the existing ones. The label sections are the arrays of a LabelTable
+ * (labels.h), index included, so a mapped snapshot looks names up without building anything.
+ * Version 1 files, whose labels were one character per vertex, are still read. Files written
+ * before the weight range was stored in the header get it from a scan of the weights.
+ *
+ * Loading is O(1) in the size of the graph: it checks that every section lies within the file
+ * and that the offsets start at 0 and end at E, but not what the sections hold. checkGraph is
+ * the O(V + E) pass over the contents, for files that come from elsewhere (graph-convert --check).
+ */
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "graph.h"
+
+#define SNAPSHOT_MAGIC "GRAPHCSR"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_ALIGN 64
+#define SNAPSHOT_HAS_LABELS 1u
+#define SNAPSHOT_HAS_WEIGHT_RANGE 2u
+
+typedef struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder; // Reads back as SNAPSHOT_BYTE_ORDER only on a machine with the same endianness
+    int64_t V;
+    int64_t E;
+    uint64_t flags;
+    uint64_t offsetsAt;
+    uint64_t destAt;
+    uint64_t weightAt;
+    uint64_t labelsAt;         // Version 1: one character per vertex and a NUL; version 2: label starts
+    uint64_t labelTextAt;      // The fields below are only in version 2
+    uint64_t labelTextSize;
+    uint64_t labelSlotsAt;
+    int64_t labelSlotCount;
+    int64_t labelLongest;
+    int32_t minWeight;         // Only with SNAPSHOT_HAS_WEIGHT_RANGE
+    int32_t maxWeight;
+} SnapshotHeader;
+
+// Function to check whether a file starts with the snapshot magic
+GRAPH_API bool isSnapshotFile(const char *fileName) {
+    char magic[8];
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    bool found = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, SNAPSHOT_MAGIC, 8) == 0;
+    fclose(file);
+    return found;
+}
+
+GRAPH_API uint64_t alignSnapshot(uint64_t position) {
+    return (position + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
+
+// Function to write one section, padding the file up to its recorded position first
+GRAPH_API void writeSection(FILE *file, uint64_t *position, uint64_t at, const void *data, size_t size) {
+    static const char zeros[SNAPSHOT_ALIGN] = {0};
+    fwrite(zeros, 1, at - *position, file);
+    fwrite(data, 1, size, file);
+    *position = at + size;
+}
+
+// Function to save the graph as a snapshot
+GRAPH_API void writeSnapshot(const Graph *graph, const char *fileName) {
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) {
+        printf("Error creating %s.\n", fileName);
+        exit(1);
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.V = graph->V;
+    header.E = graph->E;
+    header.flags = (graph->labels != NULL ? SNAPSHOT_HAS_LABELS : 0) | SNAPSHOT_HAS_WEIGHT_RANGE;
+    header.minWeight = graph->minWeight;
+    header.maxWeight = graph->maxWeight;
+    header.offsetsAt = alignSnapshot(sizeof(header));
+    header.destAt = alignSnapshot(header.offsetsAt + (graph->V + 1) * sizeof(int64_t));
+    header.weightAt = alignSnapshot(header.destAt + graph->E * sizeof(int));
+    header.labelsAt = alignSnapshot(header.weightAt + graph->E * sizeof(int));
+    const LabelTable *labels = graph->labels;
+    if (labels != NULL) {
+        header.labelTextSize = labelTextSize(labels);
+        header.labelSlotCount = labels->slotCount;
+        header.labelLongest = labels->longest;
+        header.labelTextAt = alignSnapshot(header.labelsAt + (graph->V + 1) * sizeof(int64_t));
+        header.labelSlotsAt = alignSnapshot(header.labelTextAt + header.labelTextSize);
+    }
+
+    uint64_t position = 0;
+    writeSection(file, &position, 0, &header, sizeof(header));
+    writeSection(file, &position, header.offsetsAt, graph->offsets, (graph->V + 1) * sizeof(int64_t));
+    writeSection(file, &position, header.destAt, graph->dest, graph->E * sizeof(int));
+    writeSection(file, &position, header.weightAt, graph->weight, graph->E * sizeof(int));
+    if (labels != NULL) {
+        writeSection(file, &position, header.labelsAt, labels->start, (graph->V + 1) * sizeof(int64_t));
+        writeSection(file, &position, header.labelTextAt, labels->text, header.labelTextSize);
+        writeSection(file, &position, header.labelSlotsAt, labels->slots, header.labelSlotCount * sizeof(uint64_t));
+    }
+
+    if (ferror(file) || fclose(file) != 0) {
+        printf("Error writing %s.\n", fileName);
+        exit(1);
+    }
+}
+
+// Function to check that count items of itemSize bytes starting at byte 'at' end within a file
+// of the given size, without overflowing on counts or positions read from a damaged header
+GRAPH_API bool sectionFits(uint64_t at, int64_t count, size_t itemSize, size_t size) {
+    return count >= 0 && at <= size && (uint64_t)count <= (size - at) / itemSize;
+}
+
+GRAPH_API void snapshotError(const char *fileName, const char *message) {
+    printf("Error reading snapshot %s: %s\n", fileName, message);
+    exit(1);
+}
+
+// Function to check CSR arrays: offsets start at 0, never decrease and end at count, and the
+// target of every item is a vertex. The targets are the first int of each item, stride bytes
+// apart. Returns what is wrong, or NULL
+GRAPH_API const char *checkCsr(const int64_t *offsets, int V, int64_t count, const void *items, size_t stride) {
+    if (offsets[0] != 0 || offsets[V] != count) {
+        return "offsets do not match the item count";
+    }
+    for (int v = 0; v < V; ++v) {
+        if (offsets[v + 1] < offsets[v]) {
+            return "offsets decrease";
+        }
+    }
+    const char *item = (const char *)items;
+    for (int64_t i = 0; i < count; ++i, item += stride) {
+        int target;
+        memcpy(&target, item, sizeof(int));
+        if (target < 0 || target >= V) {
+            return "an edge leads to a vertex that does not exist";
+        }
+    }
+    return NULL;
+}
+
+// Function to check everything loadSnapshot takes on trust, in O(V + E): the CSR arrays, that
+// the weights lie within the stored range, and that every name ends before the next one starts.
+// Returns what is wrong, or NULL
+GRAPH_API const char *checkGraph(const Graph *graph) {
+    const char *problem = checkCsr(graph->offsets, graph->V, graph->E, graph->dest, sizeof(int));
+    if (problem != NULL) {
+        return problem;
+    }
+    for (int64_t e = 0; e < graph->E; ++e) {
+        if (graph->weight[e] < graph->minWeight || graph->weight[e] > graph->maxWeight) {
+            return "a weight lies outside the stored weight range";
+        }
+    }
+    const LabelTable *labels = graph->labels;
+    if (labels != NULL) {
+        for (int v = 0; v < graph->V; ++v) {
+            int64_t end = labels->start[v + 1];
+            if (end - labels->start[v] < 1 + (int64_t)sizeof(int32_t) || end > labels->start[graph->V] ||
+                labels->text[end - sizeof(int32_t) - 1] != '\0') {
+                return "label starts do not delimit the names";
+            }
+        }
+    }
+    return NULL;
+}
+
+// Function to map a snapshot; the graph points straight into the mapping, nothing is copied
+GRAPH_API Graph *loadSnapshot(const char *fileName) {
+    int fd = open(fileName, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        printf("Error opening the file.\n");
+        exit(1);
+    }
+    size_t size = (size_t)info.st_size;
+    if (size < sizeof(SnapshotHeader)) {
+        snapshotError(fileName, "truncated header");
+    }
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        snapshotError(fileName, "mmap failed");
+    }
+
+    const SnapshotHeader *header = (const SnapshotHeader *)map;
+    const char *base = (const char *)map;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, 8) != 0) {
+        snapshotError(fileName, "bad magic");
+    }
+    if (header->version != 1 && header->version != SNAPSHOT_VERSION) {
+        snapshotError(fileName, "unsupported version");
+    }
+    if (header->byteOrder != SNAPSHOT_BYTE_ORDER) {
+        snapshotError(fileName, "written on a machine with a different byte order");
+    }
+    bool named = (header->flags & SNAPSHOT_HAS_LABELS) != 0;
+    if (header->V < 0 || header->V >= INT32_MAX ||
+        !sectionFits(header->offsetsAt, header->V + 1, sizeof(int64_t), size) ||
+        !sectionFits(header->destAt, header->E, sizeof(int), size) ||
+        !sectionFits(header->weightAt, header->E, sizeof(int), size) ||
+        (named && header->version == 1 && !sectionFits(header->labelsAt, header->V + 1, 1, size))) {
+        snapshotError(fileName, "sections run past the end of the file");
+    }
+    if (named && header->version == SNAPSHOT_VERSION &&
+        (!sectionFits(header->labelsAt, header->V + 1, sizeof(int64_t), size) ||
+         header->labelTextSize > INT64_MAX ||
+         !sectionFits(header->labelTextAt, (int64_t)header->labelTextSize, 1, size) ||
+         header->labelSlotCount <= header->V || (header->labelSlotCount & (header->labelSlotCount - 1)) != 0 ||
+         !sectionFits(header->labelSlotsAt, header->labelSlotCount, sizeof(uint64_t), size))) {
+        snapshotError(fileName, "label sections run past the end of the file");
+    }
+
+    Graph *graph = (Graph *)xmalloc(sizeof(Graph));
+    graph->V = (int)header->V;
+    graph->E = header->E;
+    graph->offsets = (int64_t *)(base + header->offsetsAt);
+    graph->dest = (int *)(base + header->destAt);
+    graph->weight = (int *)(base + header->weightAt);
+    graph->labels = NULL;
+    graph->mapping = map;
+    graph->mappingSize = size;
+    initArena(&graph->arena);
+    if (graph->offsets[0] != 0 || graph->offsets[graph->V] != graph->E) {
+        snapshotError(fileName, "offsets do not match the edge count");
+    }
+    if (header->flags & SNAPSHOT_HAS_WEIGHT_RANGE) {
+        graph->minWeight = header->minWeight;
+        graph->maxWeight = header->maxWeight;
+    } else {
+        graph->minWeight = graph->maxWeight = 0;
+        for (int64_t e = 0; e < graph->E; ++e) {
+            int weight = graph->weight[e];
+            graph->minWeight = e == 0 || weight < graph->minWeight ? weight : graph->minWeight;
+            graph->maxWeight = e == 0 || weight > graph->maxWeight ? weight : graph->maxWeight;
+        }
+    }
+    if (named && header->version == SNAPSHOT_VERSION) {
+        // The table lives in the graph's arena, its arrays in the mapping
+        LabelTable *labels = (LabelTable *)arenaAlloc(&graph->arena, sizeof(LabelTable));
+        labels->count = graph->V;
+        labels->longest = (int)header->labelLongest;
+        labels->start = (int64_t *)(base + header->labelsAt);
+        labels->text = (char *)(base + header->labelTextAt);
+        labels->slots = (uint64_t *)(base + header->labelSlotsAt);
+        labels->slotCount = header->labelSlotCount;
+        labels->capacity = 0;
+        labels->textCapacity = 0;
+        if (labels->start[0] != sizeof(int32_t) || labelTextSize(labels) != (int64_t)header->labelTextSize) {
+            snapshotError(fileName, "label starts do not match the label text");
+        }
+        graph->labels = labels;
+    } else if (named) {
+        LabelTable labels;
+        initLabels(&labels);
+        for (int v = 0; v < graph->V; ++v) {
+            appendLabel(&labels, base + header->labelsAt + v, 1);
+        }
+        graph->labels = copyLabels(&labels, &graph->arena);
+        freeLabels(&labels);
+    }
+    return graph;
+}
+
+#endif // SNAPSHOT_H
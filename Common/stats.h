@@ -0,0 +1,194 @@
+/**
+ * @file stats.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Phase timers, algorithm counters and peak memory, reported as JSON with --stats.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Every tool accepts --stats (report on stderr) or --stats=FILE (one line appended per run)
+ * and prints, when it exits, the seconds spent in each phase (parse, build, compute,
+ * output), the counters below and the peak resident memory. Hot loops never touch the
+ * shared counters: they count in locals with STAT_INC / STAT_ADD and hand the totals over
+ * once per run with statAdd, which is a single atomic add, so threads can report too.
+ * Building with -DGRAPH_NO_STATS turns STAT_INC, STAT_ADD, statAdd and statPhase into nothing.
+ */
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+typedef enum StatPhase {
+    PHASE_PARSE,     // Reading the input file into edges
+    PHASE_BUILD,     // Turning the edges into the CSR graph
+    PHASE_COMPUTE,
+    PHASE_OUTPUT,
+    PHASE_COUNT
+} StatPhase;
+
+typedef enum StatCounter {
+    STAT_EDGES_READ,
+    STAT_EDGES_SCANNED,     // Edges looked at by a search or a linking pass
+    STAT_EDGES_RELAXED,     // Edges that lowered a distance or a key
+    STAT_HEAP_PUSHES,
+    STAT_HEAP_DECREASES,
+    STAT_HEAP_POPS,
+    STAT_VERTICES_SETTLED,
+    STAT_MIN_SCAN_STEPS,    // Vertices looked at by the O(V) minimum scans
+    STAT_SEARCH_NODES,      // Partial mappings tried by the isomorphism search
+    STAT_COUNTER_COUNT
+} StatCounter;
+
+static const char *const statPhaseNames[PHASE_COUNT] = {"parse", "build", "compute", "output"};
+static const char *const statCounterNames[STAT_COUNTER_COUNT] = {
+    "edges_read", "edges_scanned", "edges_relaxed", "heap_pushes", "heap_decreases",
+    "heap_pops", "vertices_settled", "min_scan_steps", "search_nodes"};
+
+#define STAT_MAX_INPUTS 4
+
+typedef struct GraphStats {
+    bool enabled;
+    const char *tool;
+    const char *destination;   // File to append the report to, or NULL for stderr
+    const char *inputs[STAT_MAX_INPUTS];
+    int inputCount;
+    double start;
+    int phase;                 // Phase being timed, or -1
+    double phaseStart;
+    double seconds[PHASE_COUNT];
+    int64_t counters[STAT_COUNTER_COUNT];
+} GraphStats;
+
+static GraphStats graphStats;
+
+#ifdef GRAPH_NO_STATS
+#define STAT_INC(counter) ((void)0)
+#define STAT_ADD(counter, amount) ((void)(amount)) // Still evaluated, in case it has effects
+#else
+#define STAT_INC(counter) ((counter)++)
+#define STAT_ADD(counter, amount) ((counter) += (amount))
+#endif
+
+// Function to close the phase being timed and start timing the given one
+GRAPH_API void statPhase(StatPhase phase) {
+#ifndef GRAPH_NO_STATS
+    if (!graphStats.enabled) {
+        return;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double now = ts.tv_sec + ts.tv_nsec * 1e-9;
+    if (graphStats.phase >= 0) {
+        graphStats.seconds[graphStats.phase] += now - graphStats.phaseStart;
+    }
+    graphStats.phase = phase;
+    graphStats.phaseStart = now;
+#else
+    (void)phase;
+#endif
+}
+
+// Function to add to a counter; safe to call from several threads
+GRAPH_API void statAdd(StatCounter counter, int64_t amount) {
+#ifndef GRAPH_NO_STATS
+    __atomic_fetch_add(&graphStats.counters[counter], amount, __ATOMIC_RELAXED);
+#else
+    (void)counter;
+    (void)amount;
+#endif
+}
+
+// Function to remember an input file for the report
+GRAPH_API void statInput(const char *fileName) {
+    if (graphStats.inputCount < STAT_MAX_INPUTS) {
+        graphStats.inputs[graphStats.inputCount++] = fileName;
+    }
+}
+
+GRAPH_API void printJsonString(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const char *p = text; *p != '\0'; ++p) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(out, "\\%c", *p);
+        } else if ((unsigned char)*p < 0x20) {
+            fprintf(out, "\\u%04x", *p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Function to print the report as one line of JSON
+GRAPH_API void printStats(FILE *out) {
+    statPhase(PHASE_OUTPUT); // Closes the last phase
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(out, "{\"tool\": ");
+    printJsonString(out, graphStats.tool);
+    fprintf(out, ", \"inputs\": [");
+    for (int i = 0; i < graphStats.inputCount; ++i) {
+        fputs(i > 0 ? ", " : "", out);
+        printJsonString(out, graphStats.inputs[i]);
+    }
+    fprintf(out, "], \"seconds\": %.6f", ts.tv_sec + ts.tv_nsec * 1e-9 - graphStats.start);
+#ifndef GRAPH_NO_STATS
+    fprintf(out, ", \"phases\": {");
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        fprintf(out, "%s\"%s\": %.6f", p > 0 ? ", " : "", statPhaseNames[p], graphStats.seconds[p]);
+    }
+    fprintf(out, "}, \"counters\": {");
+    for (int c = 0; c < STAT_COUNTER_COUNT; ++c) {
+        fprintf(out, "%s\"%s\": %lld", c > 0 ? ", " : "", statCounterNames[c], (long long)graphStats.counters[c]);
+    }
+    fprintf(out, "}");
+#else
+    fprintf(out, ", \"phases\": null, \"counters\": null");
+#endif
+    fprintf(out, ", \"peak_rss_kb\": %ld}\n", usage.ru_maxrss);
+}
+
+GRAPH_API void reportStatsAtExit(void) {
+    fflush(stdout);
+    FILE *out = graphStats.destination != NULL ? fopen(graphStats.destination, "a") : stderr;
+    if (out == NULL) {
+        fprintf(stderr, "Cannot write the statistics to %s.\n", graphStats.destination);
+        return;
+    }
+    printStats(out);
+    if (out != stderr) {
+        fclose(out);
+    }
+}
+
+// Function to take --stats or --stats=FILE from the command line; returns false for any other
+// argument. The report is printed when the program exits, whichever way it exits.
+GRAPH_API bool statsOption(const char *arg, const char *tool) {
+    if (strcmp(arg, "--stats") != 0 && strncmp(arg, "--stats=", 8) != 0) {
+        return false;
+    }
+    graphStats.destination = arg[7] == '=' ? arg + 8 : NULL;
+    if (!graphStats.enabled) {
+        const char *slash = strrchr(tool, '/');
+        graphStats.tool = slash != NULL ? slash + 1 : tool;
+        graphStats.enabled = true;
+        graphStats.phase = -1;
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        graphStats.start = ts.tv_sec + ts.tv_nsec * 1e-9;
+        atexit(reportStatsAtExit);
+    }
+    return true;
+}
+
+#endif // STATS_H
@@ -0,0 +1,84 @@
+/**
+ * @file unionfind.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Union-find that several threads can use at once, built on compare-and-swap.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Roots are linked by index (the larger root goes under the smaller one) with a CAS on the
+ * root's parent slot, so a link only succeeds while the root is still a root. Finds halve
+ * the path as they go; a failed halving CAS is harmless, another thread moved the vertex
+ * closer to the root already.
+ */
+#ifndef UNIONFIND_H
+#define UNIONFIND_H
+
+#include "graph.h"
+
+typedef struct UnionFind {
+    int n;
+    int *parent;
+} UnionFind;
+
+GRAPH_API void initUnionFind(UnionFind *uf, int n) {
+    uf->n = n;
+    uf->parent = (int *)xmalloc((n > 0 ? n : 1) * sizeof(int));
+    for (int v = 0; v < n; ++v) {
+        uf->parent[v] = v;
+    }
+}
+
+// Function to add singleton sets up to n elements; not safe while other threads use the structure
+GRAPH_API void growUnionFind(UnionFind *uf, int n) {
+    if (n <= uf->n) {
+        return;
+    }
+    uf->parent = (int *)xrealloc(uf->parent, n * sizeof(int));
+    for (int v = uf->n; v < n; ++v) {
+        uf->parent[v] = v;
+    }
+    uf->n = n;
+}
+
+GRAPH_API void freeUnionFind(UnionFind *uf) {
+    free(uf->parent);
+}
+
+// Function to find the root of the set holding v, halving the path on the way
+GRAPH_API int ufFind(UnionFind *uf, int v) {
+    for (;;) {
+        int p = __atomic_load_n(&uf->parent[v], __ATOMIC_RELAXED);
+        if (p == v) {
+            return v;
+        }
+        int grand = __atomic_load_n(&uf->parent[p], __ATOMIC_RELAXED);
+        if (grand != p) {
+            __atomic_compare_exchange_n(&uf->parent[v], &p, grand, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        v = grand;
+    }
+}
+
+// Function to merge the sets of a and b; true when this call joined two different sets
+GRAPH_API bool ufUnion(UnionFind *uf, int a, int b) {
+    for (;;) {
+        a = ufFind(uf, a);
+        b = ufFind(uf, b);
+        if (a == b) {
+            return false;
+        }
+        if (a < b) {
+            int swap = a;
+            a = b;
+            b = swap;
+        }
+        int expected = a;
+        if (__atomic_compare_exchange_n(&uf->parent[a], &expected, b, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+}
+
+#endif // UNIONFIND_H
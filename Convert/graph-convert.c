@@ -0,0 +1,79 @@
+/**
+ * @file graph-convert.c
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief A program to convert a graph in any supported text format into a binary snapshot,
+ *        and to check the contents of a snapshot or a contraction hierarchy index.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../Common/loader.h"
+#include "../Dijkstra/ch.h"
+
+// Function to run the O(V + E) checks the tools skip when they map a file, for a snapshot,
+// an index or a text graph; returns the exit status
+int checkFile(const char *fileName) {
+    double start = nowSeconds();
+    const char *problem;
+    if (isHierarchyFile(fileName)) {
+        ContractionHierarchy *ch = loadHierarchy(fileName);
+        problem = checkHierarchy(ch);
+        printf("%s: contraction hierarchy, %d vertices, %lld shortcuts", fileName, ch->V, (long long)ch->shortcuts);
+        freeHierarchy(ch);
+    } else {
+        Graph *graph = createGraph(fileName);
+        problem = checkGraph(graph);
+        printf("%s: %d vertices, %lld edges", fileName, graph->V, (long long)graph->E);
+        freeGraph(graph);
+    }
+    if (problem != NULL) {
+        printf(": %s.\n", problem);
+        return 1;
+    }
+    printf(", checked in %.3f s.\n", nowSeconds() - start);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    char *files[2];
+    int count = 0;
+    bool check = false;
+    for (int i = 1; i < argc; ++i) {
+        if (statsOption(argv[i], argv[0])) {
+            continue;
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check = true;
+            continue;
+        } else if (count < 2) {
+            files[count] = argv[i];
+        }
+        count++;
+    }
+    if (check && count == 1) {
+        return checkFile(files[0]);
+    }
+    if (check || count != 2) {
+        printf("Usage: %s <input> <output snapshot> [--stats[=FILE]]\n", argv[0]);
+        printf("       %s --check <snapshot, index or graph>\n", argv[0]);
+        return 1;
+    }
+
+    double start = nowSeconds();
+    Graph *graph = createGraph(files[0]);
+    double loaded = nowSeconds();
+    statPhase(PHASE_OUTPUT);
+    writeSnapshot(graph, files[1]);
+    double written = nowSeconds();
+
+    printf("Converted %s: %d vertices, %lld edges%s\n", files[0], graph->V, (long long)graph->E,
+           graph->labels != NULL ? ", labelled" : "");
+    printf("Load %.3f s, write %.3f s -> %s\n", loaded - start, written - loaded, files[1]);
+
+    freeGraph(graph);
+    return 0;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file batch.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Multi-source shortest paths: independent Dijkstra runs spread over a pool of threads.
+ * @version 0.1
+ * @date 2023-10-16
+ * @copyright Copyright (c) 2023
+ *
+ * All threads share the read-only Graph. Each one owns an SsspWorkspace that is reused
+ * for every source it takes, and sources are handed out through an atomic counter.
+ * Results are streamed as text rows, or written into a binary distance matrix:
+ *   DistanceMatrixHeader | sources (int32 x count) | rows (int64 x V, one per source)
+ * where unreachable vertices hold DIST_INF (INT64_MAX).
+ */
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Common/parallel.h"
+#include "sssp.h"
+
+#define MATRIX_MAGIC "GRAPHDST"
+#define MATRIX_VERSION 1
+
+typedef struct DistanceMatrixHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder; // 0x01020304 in the byte order of the machine that wrote it
+    int64_t sources;
+    int64_t V;
+    uint64_t sourcesAt;
+    uint64_t rowsAt;
+} DistanceMatrixHeader;
+
+typedef struct BatchRun
+{
+    const Graph *graph;
+    SsspEngine engine;
+    const int *sources;
+    int count;
+    atomic_int next;
+    FILE *rows;          // Text rows go here when no matrix file is used
+    int matrixFd;        // Binary distance matrix, or -1
+    uint64_t rowsAt;
+    pthread_mutex_t lock;
+} BatchRun;
+
+// Function to append a decimal number to a growing text buffer
+GRAPH_API void appendNumber(char **buffer, size_t *length, size_t *capacity, int64_t value)
+{
+    if (*length + 24 > *capacity)
+    {
+        *capacity = (*capacity + 24) * 2;
+        *buffer = (char *)xrealloc(*buffer, *capacity);
+    }
+    (*buffer)[(*length)++] = ' ';
+    if (value == DIST_INF)
+    {
+        memcpy(*buffer + *length, "inf", 3);
+        *length += 3;
+    }
+    else
+    {
+        *length += formatInt(*buffer + *length, value);
+    }
+}
+
+// Function to append the label of a vertex, or its number when the graph has no labels, to a
+// growing text buffer, without the leading space appendNumber puts before a number
+GRAPH_API void appendVertex(char **buffer, size_t *length, size_t *capacity, const Graph *graph, int v)
+{
+    size_t size = graph->labels != NULL ? labelLength(graph->labels, v) : 20;
+    if (*length + size + 24 > *capacity)
+    {
+        *capacity = (*capacity + size + 24) * 2;
+        *buffer = (char *)xrealloc(*buffer, *capacity);
+    }
+    if (graph->labels != NULL)
+    {
+        memcpy(*buffer + *length, labelName(graph->labels, v), size);
+        *length += size;
+    }
+    else
+    {
+        *length += formatInt(*buffer + *length, v);
+    }
+}
+
+GRAPH_API void batchWorker(void *context, int thread, int threads)
+{
+    (void)thread;
+    (void)threads;
+    BatchRun *run = (BatchRun *)context;
+    const Graph *graph = run->graph;
+    SsspWorkspace ws;
+    initWorkspace(&ws, graph->V);
+    char *line = NULL;
+    size_t capacity = 0;
+
+    for (int i = atomic_fetch_add(&run->next, 1); i < run->count; i = atomic_fetch_add(&run->next, 1))
+    {
+        int src = run->sources[i];
+        dijkstra(graph, src, run->engine, &ws);
+
+        if (run->matrixFd >= 0)
+        {
+            // Every row has a fixed place in the file, so threads write without a lock
+            size_t bytes = (size_t)graph->V * sizeof(int64_t);
+            off_t at = (off_t)(run->rowsAt + (uint64_t)i * bytes);
+            for (size_t done = 0; done < bytes;)
+            {
+                ssize_t written = pwrite(run->matrixFd, (char *)ws.dist + done, bytes - done, at + done);
+                if (written <= 0)
+                {
+                    printf("Error writing the distance matrix.\n");
+                    exit(1);
+                }
+                done += (size_t)written;
+            }
+        }
+        else
+        {
+            size_t length = 0;
+            appendVertex(&line, &length, &capacity, graph, src);
+            line[length++] = ':';
+            for (int v = 0; v < graph->V; v++)
+            {
+                appendNumber(&line, &length, &capacity, ws.dist[v]);
+            }
+            line[length++] = '\n';
+            pthread_mutex_lock(&run->lock);
+            fwrite(line, 1, length, run->rows);
+            pthread_mutex_unlock(&run->lock);
+        }
+    }
+
+    free(line);
+    freeWorkspace(&ws);
+}
+
+// Function to open the matrix file and write its header and source list
+GRAPH_API int createDistanceMatrix(const char *fileName, const Graph *graph, const int *sources, int count, uint64_t *rowsAt)
+{
+    int fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        printf("Error creating %s.\n", fileName);
+        exit(1);
+    }
+    DistanceMatrixHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MATRIX_MAGIC, 8);
+    header.version = MATRIX_VERSION;
+    header.byteOrder = 0x01020304u;
+    header.sources = count;
+    header.V = graph->V;
+    header.sourcesAt = sizeof(header);
+    header.rowsAt = (header.sourcesAt + count * sizeof(int32_t) + 7) / 8 * 8;
+    *rowsAt = header.rowsAt;
+
+    if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        pwrite(fd, sources, count * sizeof(int32_t), (off_t)header.sourcesAt) != (ssize_t)(count * sizeof(int32_t)) ||
+        ftruncate(fd, (off_t)(header.rowsAt + (uint64_t)count * graph->V * sizeof(int64_t))) != 0)
+    {
+        printf("Error writing %s.\n", fileName);
+        exit(1);
+    }
+    return fd;
+}
+
+// Function to run Dijkstra from every source on the given number of threads
+GRAPH_API void dijkstraBatch(const Graph *graph, const int *sources, int count, SsspEngine engine, int threads, const char *matrixFile)
+{
+    BatchRun run;
+    run.graph = graph;
+    run.engine = engine;
+    run.sources = sources;
+    run.count = count;
+    atomic_init(&run.next, 0);
+    run.rows = stdout;
+    run.matrixFd = matrixFile != NULL ? createDistanceMatrix(matrixFile, graph, sources, count, &run.rowsAt) : -1;
+    pthread_mutex_init(&run.lock, NULL);
+
+    parallelRun(threads < count ? threads : count, batchWorker, &run);
+
+    pthread_mutex_destroy(&run.lock);
+    if (run.matrixFd >= 0 && close(run.matrixFd) != 0)
+    {
+        printf("Error writing %s.\n", matrixFile);
+        exit(1);
+    }
+    fflush(stdout);
+}
+
+#endif // BATCH_H
@@ -0,0 +1,187 @@
+/**
+ * @file bidirectional.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Point-to-point shortest path: bidirectional Dijkstra with early exit and path output.
+ * @version 0.1
+ * @date 2023-10-16
+ * @copyright Copyright (c) 2023
+ *
+ * A forward search from the source on the graph and a backward search from the target
+ * on the reverse graph take turns settling vertices. Every edge that reaches a vertex
+ * already labelled by the other side proposes a path; the search stops once the two
+ * smallest heap keys add up to at least the best proposal. Only the vertices the searches
+ * touched are reset afterwards, so a query does not pay O(V) after the first one.
+ */
+#ifndef BIDIRECTIONAL_H
+#define BIDIRECTIONAL_H
+
+#include "sssp.h"
+
+typedef struct BidirectionalSearch
+{
+    int V;
+    int64_t *dist[2]; // [0] from the source, [1] to the target
+    int *pred[2];     // Previous vertex towards the source / next vertex towards the target
+    IndexedHeap heap[2];
+    int *touched;
+    int touchedCount;
+    int64_t settled;  // Vertices settled by the last query, both sides together
+} BidirectionalSearch;
+
+typedef struct PathResult
+{
+    int64_t distance; // DIST_INF when the target cannot be reached
+    int *path;        // Vertices from source to target
+    int length;
+} PathResult;
+
+GRAPH_API void initBidirectional(BidirectionalSearch *search, int V)
+{
+    search->V = V;
+    for (int side = 0; side < 2; side++)
+    {
+        search->dist[side] = (int64_t *)xmalloc(V * sizeof(int64_t));
+        search->pred[side] = (int *)xmalloc(V * sizeof(int));
+        initHeap(&search->heap[side], V);
+        for (int v = 0; v < V; v++)
+        {
+            search->dist[side][v] = DIST_INF;
+            search->pred[side][v] = -1;
+        }
+    }
+    search->touched = (int *)xmalloc(V * sizeof(int));
+    search->touchedCount = 0;
+}
+
+GRAPH_API void freeBidirectional(BidirectionalSearch *search)
+{
+    for (int side = 0; side < 2; side++)
+    {
+        free(search->dist[side]);
+        free(search->pred[side]);
+        freeHeap(&search->heap[side]);
+    }
+    free(search->touched);
+}
+
+// Function to give vertex v a label on one side, remembering it for the reset
+GRAPH_API void label(BidirectionalSearch *search, int side, int v, int64_t dist, int pred)
+{
+    if (search->dist[0][v] == DIST_INF && search->dist[1][v] == DIST_INF)
+    {
+        search->touched[search->touchedCount++] = v;
+    }
+    search->dist[side][v] = dist;
+    search->pred[side][v] = pred;
+    heapPushOrDecrease(&search->heap[side], v, dist);
+}
+
+// Function to find the shortest path from src to dst; reverse is transposeGraph(graph)
+GRAPH_API PathResult bidirectionalDijkstra(const Graph *graph, const Graph *reverse, int src, int dst, BidirectionalSearch *search)
+{
+    const Graph *sides[2] = {graph, reverse};
+    int64_t best = DIST_INF;
+    int meet = -1;
+    search->settled = 0;
+
+    // Reset what the previous query touched
+    for (int i = 0; i < search->touchedCount; i++)
+    {
+        int v = search->touched[i];
+        search->dist[0][v] = search->dist[1][v] = DIST_INF;
+        search->pred[0][v] = search->pred[1][v] = -1;
+    }
+    search->touchedCount = 0;
+    clearHeap(&search->heap[0]);
+    clearHeap(&search->heap[1]);
+
+    label(search, 0, src, 0, -1);
+    label(search, 1, dst, 0, -1);
+    if (src == dst)
+    {
+        best = 0;
+        meet = src;
+    }
+
+    int64_t scanned = 0, relaxed = 0;
+    while (!heapEmpty(&search->heap[0]) && !heapEmpty(&search->heap[1]))
+    {
+        int64_t top0 = search->heap[0].key[search->heap[0].items[0]];
+        int64_t top1 = search->heap[1].key[search->heap[1].items[0]];
+        if (best != DIST_INF && top0 + top1 >= best)
+        {
+            break; // No path through an unsettled vertex can be shorter
+        }
+
+        // Expand the side with the smaller frontier
+        int side = search->heap[0].size <= search->heap[1].size ? 0 : 1;
+        const Graph *g = sides[side];
+        int64_t *dist = search->dist[side];
+        int64_t *other = search->dist[1 - side];
+        int u = heapPop(&search->heap[side]);
+        search->settled++;
+        STAT_ADD(scanned, g->offsets[u + 1] - g->offsets[u]);
+
+        for (int64_t e = g->offsets[u]; e < g->offsets[u + 1]; e++)
+        {
+            int v = g->dest[e];
+            int64_t candidate = dist[u] + g->weight[e];
+            if (candidate < dist[v])
+            {
+                label(search, side, v, candidate, u);
+                STAT_INC(relaxed);
+            }
+            if (other[v] != DIST_INF && candidate + other[v] < best)
+            {
+                best = candidate + other[v];
+                meet = v;
+            }
+        }
+    }
+
+    statAdd(STAT_VERTICES_SETTLED, search->settled);
+    statAdd(STAT_EDGES_SCANNED, scanned);
+    statAdd(STAT_EDGES_RELAXED, relaxed);
+    publishHeapStats(&search->heap[0]);
+    publishHeapStats(&search->heap[1]);
+
+    PathResult result;
+    result.distance = best;
+    result.path = NULL;
+    result.length = 0;
+    if (meet < 0)
+    {
+        return result;
+    }
+
+    // Walk back to the source, then forward to the target
+    int count = 0;
+    for (int v = meet; v != -1; v = search->pred[0][v])
+    {
+        count++;
+    }
+    for (int v = search->pred[1][meet]; v != -1; v = search->pred[1][v])
+    {
+        count++;
+    }
+    result.path = (int *)xmalloc(count * sizeof(int));
+    result.length = count;
+    int i = 0;
+    for (int v = meet; v != -1; v = search->pred[0][v])
+    {
+        result.path[i++] = v;
+    }
+    for (int a = 0, b = i - 1; a < b; a++, b--)
+    {
+        int swap = result.path[a];
+        result.path[a] = result.path[b];
+        result.path[b] = swap;
+    }
+    for (int v = search->pred[1][meet]; v != -1; v = search->pred[1][v])
+    {
+        result.path[i++] = v;
+    }
+    return result;
+}
+
+#endif // BIDIRECTIONAL_H
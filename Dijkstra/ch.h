@@ -0,0 +1,605 @@
+/**
+ * @file ch.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Contraction hierarchy: offline preprocessing, index file and upward bidirectional queries.
+ * @version 0.1
+ * @date 2023-10-16
+ * @copyright Copyright (c) 2023
+ *
+ * Preprocessing contracts vertices one at a time, least important first (edge difference
+ * plus contracted neighbours, updated lazily). Contracting v adds a shortcut u -> w for
+ * every pair of remaining neighbours whose best path runs through v; a local witness
+ * search bounded in settled vertices decides that, adding the shortcut when in doubt.
+ * The order is the rank of each vertex, and the edges each vertex still had when it was
+ * contracted all lead to higher ranks: they form the upward graph (out-edges) and the
+ * backward upward graph (in-edges). A query searches upward from both ends and takes the
+ * best vertex where the searches meet.
+ *
+ * Index file (native byte order, sections aligned to 8 bytes):
+ *   ChHeader | rank (int32 x V) | up offsets (int64 x V + 1) | up arcs (ChArc x U)
+ *            | down offsets (int64 x V + 1) | down arcs (ChArc x D)
+ */
+#ifndef CH_H
+#define CH_H
+
+#include "../Common/snapshot.h"
+#include "sssp.h"
+
+#define CH_MAGIC "GRAPHCH1"
+#define CH_VERSION 1
+#define CH_WITNESS_LIMIT 500   // Vertices a witness search may settle before giving up
+#define CH_SIMULATE_LIMIT 50   // Same limit while only estimating priorities
+
+typedef struct ChArc
+{
+    int to;
+    int pad;
+    int64_t weight;
+} ChArc;
+
+typedef struct ChArcList
+{
+    ChArc *items;
+    int size;
+    int capacity;
+} ChArcList;
+
+typedef struct ChHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int64_t V;
+    int64_t upArcs;
+    int64_t downArcs;
+    int64_t shortcuts;
+    uint64_t rankAt;
+    uint64_t upOffsetsAt;
+    uint64_t upArcsAt;
+    uint64_t downOffsetsAt;
+    uint64_t downArcsAt;
+} ChHeader;
+
+// Hierarchy in CSR form, either built in memory or mapped from an index file
+typedef struct ContractionHierarchy
+{
+    int V;
+    int64_t shortcuts;
+    int *rank;
+    int64_t *upOffsets;
+    ChArc *up;
+    int64_t *downOffsets;
+    ChArc *down;
+    void *mapping;
+    size_t mappingSize;
+} ContractionHierarchy;
+
+// Working state of the preprocessing
+typedef struct ChBuilder
+{
+    int V;
+    ChArcList *out;
+    ChArcList *in;
+    bool *contracted;
+    int *deletedNeighbours;
+    int64_t shortcuts;
+    // Witness search scratch, reset through the touched list
+    int64_t *dist;
+    int *touched;
+    int touchedCount;
+    int *targetOf;             // targetOf[w] == v while w is an out-neighbour of the vertex v being contracted
+    IndexedHeap heap;
+} ChBuilder;
+
+// Function to add an arc, or lower its weight when the list already has one to the same vertex
+GRAPH_API bool addArc(ChArcList *list, int to, int64_t weight)
+{
+    for (int i = 0; i < list->size; i++)
+    {
+        if (list->items[i].to == to)
+        {
+            if (weight < list->items[i].weight)
+            {
+                list->items[i].weight = weight;
+            }
+            return false;
+        }
+    }
+    if (list->size == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->items = (ChArc *)xrealloc(list->items, list->capacity * sizeof(ChArc));
+    }
+    list->items[list->size].to = to;
+    list->items[list->size].pad = 0;
+    list->items[list->size].weight = weight;
+    list->size++;
+    return true;
+}
+
+// Function to run a Dijkstra from u that avoids 'via', settling at most limit vertices
+// and stopping early once all targets of 'via' are settled
+GRAPH_API void witnessSearch(ChBuilder *b, int u, int via, int targets, int64_t maxDist, int limit)
+{
+    for (int i = 0; i < b->touchedCount; i++)
+    {
+        b->dist[b->touched[i]] = DIST_INF;
+    }
+    b->touchedCount = 0;
+    clearHeap(&b->heap);
+
+    b->dist[u] = 0;
+    b->touched[b->touchedCount++] = u;
+    heapPushOrDecrease(&b->heap, u, 0);
+    for (int settled = 0; !heapEmpty(&b->heap) && settled < limit; settled++)
+    {
+        int x = heapPop(&b->heap);
+        if (b->dist[x] > maxDist || (b->targetOf[x] == via && --targets == 0))
+        {
+            break;
+        }
+        ChArcList *arcs = &b->out[x];
+        for (int i = 0; i < arcs->size; i++)
+        {
+            int y = arcs->items[i].to;
+            if (y == via || b->contracted[y])
+            {
+                continue;
+            }
+            int64_t candidate = b->dist[x] + arcs->items[i].weight;
+            if (candidate < b->dist[y])
+            {
+                if (b->dist[y] == DIST_INF)
+                {
+                    b->touched[b->touchedCount++] = y;
+                }
+                b->dist[y] = candidate;
+                heapPushOrDecrease(&b->heap, y, candidate);
+            }
+        }
+    }
+}
+
+// Function to count (or add, when simulate is false) the shortcuts that contracting v needs
+GRAPH_API int contractVertex(ChBuilder *b, int v, bool simulate)
+{
+    int shortcuts = 0;
+    ChArcList *in = &b->in[v];
+    ChArcList *out = &b->out[v];
+
+    int64_t maxOut = 0;
+    int targets = 0;
+    for (int j = 0; j < out->size; j++)
+    {
+        int w = out->items[j].to;
+        if (!b->contracted[w])
+        {
+            b->targetOf[w] = v;
+            targets++;
+            maxOut = out->items[j].weight > maxOut ? out->items[j].weight : maxOut;
+        }
+    }
+
+    for (int i = 0; i < in->size; i++)
+    {
+        int u = in->items[i].to;
+        if (b->contracted[u])
+        {
+            continue;
+        }
+        int64_t toV = in->items[i].weight;
+        witnessSearch(b, u, v, targets, toV + maxOut, simulate ? CH_SIMULATE_LIMIT : CH_WITNESS_LIMIT);
+
+        for (int j = 0; j < out->size; j++)
+        {
+            int w = out->items[j].to;
+            int64_t through = toV + out->items[j].weight;
+            if (w == u || b->contracted[w] || b->dist[w] <= through)
+            {
+                continue;
+            }
+            shortcuts++;
+            if (!simulate)
+            {
+                if (addArc(&b->out[u], w, through))
+                {
+                    b->shortcuts++;
+                }
+                addArc(&b->in[w], u, through);
+            }
+        }
+    }
+    return shortcuts;
+}
+
+// Function to score v: shortcuts added minus edges removed, plus neighbours already contracted
+GRAPH_API int64_t chPriority(ChBuilder *b, int v)
+{
+    int removed = 0;
+    for (int i = 0; i < b->in[v].size; i++)
+    {
+        removed += !b->contracted[b->in[v].items[i].to];
+    }
+    for (int i = 0; i < b->out[v].size; i++)
+    {
+        removed += !b->contracted[b->out[v].items[i].to];
+    }
+    return (int64_t)contractVertex(b, v, true) - removed + b->deletedNeighbours[v];
+}
+
+// Function to turn per-vertex arc lists into CSR arrays, freeing the lists
+GRAPH_API int64_t packArcs(ChArcList *lists, int V, int64_t **offsets, ChArc **arcs)
+{
+    *offsets = (int64_t *)xmalloc((V + 1) * sizeof(int64_t));
+    int64_t total = 0;
+    for (int v = 0; v < V; v++)
+    {
+        (*offsets)[v] = total;
+        total += lists[v].size;
+    }
+    (*offsets)[V] = total;
+    *arcs = (ChArc *)xmalloc((total ? total : 1) * sizeof(ChArc));
+    for (int v = 0; v < V; v++)
+    {
+        if (lists[v].size > 0)
+        {
+            memcpy(*arcs + (*offsets)[v], lists[v].items, lists[v].size * sizeof(ChArc));
+        }
+        free(lists[v].items);
+    }
+    free(lists);
+    return total;
+}
+
+// Function to build the contraction hierarchy of a graph
+GRAPH_API ContractionHierarchy *buildHierarchy(const Graph *graph)
+{
+    int V = graph->V;
+    ChBuilder b;
+    b.V = V;
+    b.out = (ChArcList *)xmalloc(V * sizeof(ChArcList));
+    b.in = (ChArcList *)xmalloc(V * sizeof(ChArcList));
+    memset(b.out, 0, V * sizeof(ChArcList));
+    memset(b.in, 0, V * sizeof(ChArcList));
+    b.contracted = (bool *)xmalloc(V * sizeof(bool));
+    b.deletedNeighbours = (int *)xmalloc(V * sizeof(int));
+    b.shortcuts = 0;
+    b.dist = (int64_t *)xmalloc(V * sizeof(int64_t));
+    b.touched = (int *)xmalloc(V * sizeof(int));
+    b.touchedCount = 0;
+    b.targetOf = (int *)xmalloc(V * sizeof(int));
+    initHeap(&b.heap, V);
+    for (int v = 0; v < V; v++)
+    {
+        b.contracted[v] = false;
+        b.deletedNeighbours[v] = 0;
+        b.dist[v] = DIST_INF;
+        b.targetOf[v] = -1;
+    }
+    for (int u = 0; u < V; u++)
+    {
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+        {
+            if (graph->dest[e] != u)
+            {
+                addArc(&b.out[u], graph->dest[e], graph->weight[e]);
+                addArc(&b.in[graph->dest[e]], u, graph->weight[e]);
+            }
+        }
+    }
+
+    // Upward arcs are collected per vertex as it gets contracted
+    ChArcList *up = (ChArcList *)xmalloc(V * sizeof(ChArcList));
+    ChArcList *down = (ChArcList *)xmalloc(V * sizeof(ChArcList));
+    memset(up, 0, V * sizeof(ChArcList));
+    memset(down, 0, V * sizeof(ChArcList));
+
+    IndexedHeap order;
+    initHeap(&order, V);
+    for (int v = 0; v < V; v++)
+    {
+        heapPushOrDecrease(&order, v, chPriority(&b, v));
+    }
+
+    ContractionHierarchy *ch = (ContractionHierarchy *)xmalloc(sizeof(ContractionHierarchy));
+    ch->V = V;
+    ch->rank = (int *)xmalloc(V * sizeof(int));
+    ch->mapping = NULL;
+    ch->mappingSize = 0;
+
+    int next = 0;
+    while (!heapEmpty(&order))
+    {
+        // Lazy update: re-score the best candidate and put it back if it got worse
+        int v = heapPop(&order);
+        int64_t priority = chPriority(&b, v);
+        if (!heapEmpty(&order) && priority > order.key[order.items[0]])
+        {
+            heapPushOrDecrease(&order, v, priority);
+            continue;
+        }
+
+        contractVertex(&b, v, false);
+        for (int i = 0; i < b.out[v].size; i++)
+        {
+            int w = b.out[v].items[i].to;
+            if (!b.contracted[w])
+            {
+                addArc(&up[v], w, b.out[v].items[i].weight);
+                b.deletedNeighbours[w]++;
+            }
+        }
+        for (int i = 0; i < b.in[v].size; i++)
+        {
+            int u = b.in[v].items[i].to;
+            if (!b.contracted[u])
+            {
+                addArc(&down[v], u, b.in[v].items[i].weight);
+                b.deletedNeighbours[u]++;
+            }
+        }
+        b.contracted[v] = true;
+        ch->rank[v] = next++;
+        free(b.out[v].items);
+        free(b.in[v].items);
+        b.out[v].items = b.in[v].items = NULL;
+        b.out[v].size = b.in[v].size = b.out[v].capacity = b.in[v].capacity = 0;
+    }
+
+    packArcs(up, V, &ch->upOffsets, &ch->up);
+    packArcs(down, V, &ch->downOffsets, &ch->down);
+    ch->shortcuts = b.shortcuts;
+
+    publishHeapStats(&order);
+    publishHeapStats(&b.heap);
+    freeHeap(&order);
+    freeHeap(&b.heap);
+    free(b.out);
+    free(b.in);
+    free(b.contracted);
+    free(b.deletedNeighbours);
+    free(b.dist);
+    free(b.touched);
+    free(b.targetOf);
+    return ch;
+}
+
+// Function to save the hierarchy; returns the size of the index in bytes
+GRAPH_API uint64_t writeHierarchy(const ContractionHierarchy *ch, const char *fileName)
+{
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL)
+    {
+        printf("Error creating %s.\n", fileName);
+        exit(1);
+    }
+    int64_t V = ch->V;
+    ChHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CH_MAGIC, 8);
+    header.version = CH_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.V = V;
+    header.upArcs = ch->upOffsets[V];
+    header.downArcs = ch->downOffsets[V];
+    header.shortcuts = ch->shortcuts;
+    header.rankAt = (sizeof(header) + 7) / 8 * 8;
+    header.upOffsetsAt = (header.rankAt + V * sizeof(int) + 7) / 8 * 8;
+    header.upArcsAt = header.upOffsetsAt + (V + 1) * sizeof(int64_t);
+    header.downOffsetsAt = header.upArcsAt + header.upArcs * sizeof(ChArc);
+    header.downArcsAt = header.downOffsetsAt + (V + 1) * sizeof(int64_t);
+
+    uint64_t position = 0;
+    writeSection(file, &position, 0, &header, sizeof(header));
+    writeSection(file, &position, header.rankAt, ch->rank, V * sizeof(int));
+    writeSection(file, &position, header.upOffsetsAt, ch->upOffsets, (V + 1) * sizeof(int64_t));
+    writeSection(file, &position, header.upArcsAt, ch->up, header.upArcs * sizeof(ChArc));
+    writeSection(file, &position, header.downOffsetsAt, ch->downOffsets, (V + 1) * sizeof(int64_t));
+    writeSection(file, &position, header.downArcsAt, ch->down, header.downArcs * sizeof(ChArc));
+    if (ferror(file) || fclose(file) != 0)
+    {
+        printf("Error writing %s.\n", fileName);
+        exit(1);
+    }
+    return position;
+}
+
+// Function to check whether a file starts with the hierarchy magic
+GRAPH_API bool isHierarchyFile(const char *fileName)
+{
+    char magic[8];
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool found = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, CH_MAGIC, 8) == 0;
+    fclose(file);
+    return found;
+}
+
+// Function to map an index file; the hierarchy points into the mapping. Like loadSnapshot it
+// only checks that the sections fit in the file and that the offsets end at the arc counts, in
+// O(1); checkHierarchy looks at the contents
+GRAPH_API ContractionHierarchy *loadHierarchy(const char *fileName)
+{
+    int fd = open(fileName, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        printf("Error opening the file.\n");
+        exit(1);
+    }
+    size_t size = (size_t)info.st_size;
+    void *map = size >= sizeof(ChHeader) ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        snapshotError(fileName, "truncated or unreadable index");
+    }
+    const ChHeader *header = (const ChHeader *)map;
+    const char *base = (const char *)map;
+    if (memcmp(header->magic, CH_MAGIC, 8) != 0 || header->version != CH_VERSION ||
+        header->byteOrder != SNAPSHOT_BYTE_ORDER || header->V < 0 || header->V >= INT32_MAX)
+    {
+        snapshotError(fileName, "not a valid contraction hierarchy index");
+    }
+    if (!sectionFits(header->rankAt, header->V, sizeof(int), size) ||
+        !sectionFits(header->upOffsetsAt, header->V + 1, sizeof(int64_t), size) ||
+        !sectionFits(header->upArcsAt, header->upArcs, sizeof(ChArc), size) ||
+        !sectionFits(header->downOffsetsAt, header->V + 1, sizeof(int64_t), size) ||
+        !sectionFits(header->downArcsAt, header->downArcs, sizeof(ChArc), size))
+    {
+        snapshotError(fileName, "sections run past the end of the file");
+    }
+
+    ContractionHierarchy *ch = (ContractionHierarchy *)xmalloc(sizeof(ContractionHierarchy));
+    ch->V = (int)header->V;
+    ch->shortcuts = header->shortcuts;
+    ch->rank = (int *)(base + header->rankAt);
+    ch->upOffsets = (int64_t *)(base + header->upOffsetsAt);
+    ch->up = (ChArc *)(base + header->upArcsAt);
+    ch->downOffsets = (int64_t *)(base + header->downOffsetsAt);
+    ch->down = (ChArc *)(base + header->downArcsAt);
+    ch->mapping = map;
+    ch->mappingSize = size;
+    if (ch->upOffsets[0] != 0 || ch->upOffsets[ch->V] != header->upArcs || ch->downOffsets[0] != 0 ||
+        ch->downOffsets[ch->V] != header->downArcs)
+    {
+        snapshotError(fileName, "offsets do not match the arc counts");
+    }
+    return ch;
+}
+
+// Function to check what loadHierarchy takes on trust, in O(V + U + D): that every rank is a
+// rank and that both arc arrays are well-formed CSR. Returns what is wrong, or NULL
+GRAPH_API const char *checkHierarchy(const ContractionHierarchy *ch)
+{
+    for (int v = 0; v < ch->V; v++)
+    {
+        if (ch->rank[v] < 0 || ch->rank[v] >= ch->V)
+        {
+            return "a rank lies outside 0 .. V - 1";
+        }
+    }
+    const char *problem = checkCsr(ch->upOffsets, ch->V, ch->upOffsets[ch->V], ch->up, sizeof(ChArc));
+    return problem != NULL ? problem : checkCsr(ch->downOffsets, ch->V, ch->downOffsets[ch->V], ch->down, sizeof(ChArc));
+}
+
+GRAPH_API void freeHierarchy(ContractionHierarchy *ch)
+{
+    if (ch->mapping != NULL)
+    {
+        munmap(ch->mapping, ch->mappingSize);
+    }
+    else
+    {
+        free(ch->rank);
+        free(ch->upOffsets);
+        free(ch->up);
+        free(ch->downOffsets);
+        free(ch->down);
+    }
+    free(ch);
+}
+
+// Query scratch, reused between queries and reset through the touched list
+typedef struct ChQuery
+{
+    int64_t *dist[2];
+    IndexedHeap heap[2];
+    int *touched;
+    int touchedCount;
+    int64_t settled;
+} ChQuery;
+
+GRAPH_API void initChQuery(ChQuery *query, int V)
+{
+    for (int side = 0; side < 2; side++)
+    {
+        query->dist[side] = (int64_t *)xmalloc(V * sizeof(int64_t));
+        initHeap(&query->heap[side], V);
+        for (int v = 0; v < V; v++)
+        {
+            query->dist[side][v] = DIST_INF;
+        }
+    }
+    query->touched = (int *)xmalloc(V * sizeof(int));
+    query->touchedCount = 0;
+    query->settled = 0;
+}
+
+GRAPH_API void freeChQuery(ChQuery *query)
+{
+    for (int side = 0; side < 2; side++)
+    {
+        free(query->dist[side]);
+        freeHeap(&query->heap[side]);
+    }
+    free(query->touched);
+}
+
+// Function to answer a distance query with two upward searches
+GRAPH_API int64_t chDistance(const ContractionHierarchy *ch, int src, int dst, ChQuery *query)
+{
+    for (int i = 0; i < query->touchedCount; i++)
+    {
+        query->dist[0][query->touched[i]] = query->dist[1][query->touched[i]] = DIST_INF;
+    }
+    query->touchedCount = 0;
+    query->settled = 0;
+    clearHeap(&query->heap[0]);
+    clearHeap(&query->heap[1]);
+
+    int ends[2] = {src, dst};
+    for (int side = 0; side < 2; side++)
+    {
+        if (query->dist[0][ends[side]] == DIST_INF && query->dist[1][ends[side]] == DIST_INF)
+        {
+            query->touched[query->touchedCount++] = ends[side];
+        }
+        query->dist[side][ends[side]] = 0;
+        heapPushOrDecrease(&query->heap[side], ends[side], 0);
+    }
+
+    int64_t best = src == dst ? 0 : DIST_INF;
+    const int64_t *offsets[2] = {ch->upOffsets, ch->downOffsets};
+    const ChArc *arcs[2] = {ch->up, ch->down};
+    for (int side = 0; !heapEmpty(&query->heap[0]) || !heapEmpty(&query->heap[1]); side = 1 - side)
+    {
+        IndexedHeap *heap = &query->heap[side];
+        if (heapEmpty(heap) || heap->key[heap->items[0]] >= best)
+        {
+            clearHeap(heap); // This side cannot improve the answer any more
+            continue;
+        }
+        int u = heapPop(heap);
+        query->settled++;
+        int64_t *dist = query->dist[side];
+        int64_t *other = query->dist[1 - side];
+        if (other[u] != DIST_INF && dist[u] + other[u] < best)
+        {
+            best = dist[u] + other[u];
+        }
+        for (int64_t e = offsets[side][u]; e < offsets[side][u + 1]; e++)
+        {
+            int v = arcs[side][e].to;
+            int64_t candidate = dist[u] + arcs[side][e].weight;
+            if (candidate < dist[v])
+            {
+                if (dist[v] == DIST_INF && other[v] == DIST_INF)
+                {
+                    query->touched[query->touchedCount++] = v;
+                }
+                dist[v] = candidate;
+                heapPushOrDecrease(heap, v, candidate);
+            }
+        }
+    }
+    statAdd(STAT_VERTICES_SETTLED, query->settled);
+    publishHeapStats(&query->heap[0]);
+    publishHeapStats(&query->heap[1]);
+    return best;
+}
+
+#endif // CH_H
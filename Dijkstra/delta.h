@@ -0,0 +1,276 @@
+/**
+ * @file delta.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Parallel delta-stepping single-source shortest paths (Meyer and Sanders).
+ * @version 0.1
+ * @date 2023-10-16
+ * @copyright Copyright (c) 2023
+ *
+ * Vertices are grouped in buckets of width delta by tentative distance. The current
+ * bucket is drained by relaxing light edges (weight <= delta) in parallel until it stops
+ * refilling; heavy edges of the vertices it settled are then relaxed once. Distances
+ * are lowered with an atomic compare-and-swap minimum. Each thread keeps its own ring
+ * of buckets, so pushes never contend; a ring of maxWeight / delta + 2 buckets is enough
+ * because no relaxation lands further ahead than that.
+ */
+#ifndef DELTA_H
+#define DELTA_H
+
+#include "../Common/parallel.h"
+#include "sssp.h"
+
+// Most buckets a thread's ring may hold; a smaller delta on heavier weights is refused
+#define DELTA_MAX_RING (1 << 16)
+
+typedef struct VertexList
+{
+    int *items;
+    int64_t size;
+    int64_t capacity;
+} VertexList;
+
+typedef struct DeltaRun
+{
+    const Graph *graph;
+    int64_t delta;
+    int64_t *dist;
+    atomic_bool *inSettled; // Set once a vertex is recorded for the heavy phase of the bucket
+    int ringSize;
+    VertexList **rings;     // rings[thread][bucket % ringSize]
+    int *frontier;
+    int64_t frontierSize;
+    int64_t *published;     // Entries each thread contributes to the next frontier
+    atomic_llong cursor;    // Next frontier position to hand out
+    atomic_llong nextBucket;
+    int64_t bucket;
+    pthread_barrier_t barrier;
+} DeltaRun;
+
+GRAPH_API void listPush(VertexList *list, int v)
+{
+    if (list->size == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        list->items = (int *)xrealloc(list->items, list->capacity * sizeof(int));
+    }
+    list->items[list->size++] = v;
+}
+
+// Function to lower dist[v] to candidate atomically; true when this call lowered it
+GRAPH_API bool atomicMin(int64_t *dist, int v, int64_t candidate)
+{
+    int64_t old = __atomic_load_n(&dist[v], __ATOMIC_RELAXED);
+    while (candidate < old)
+    {
+        if (__atomic_compare_exchange_n(&dist[v], &old, candidate, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function to relax the light or heavy edges of u, pushing improved vertices into this thread's ring;
+// returns the number of distances it lowered
+GRAPH_API int64_t relaxEdges(DeltaRun *run, VertexList *ring, int u, bool light)
+{
+    int64_t relaxed = 0;
+    const Graph *graph = run->graph;
+    int64_t du = __atomic_load_n(&run->dist[u], __ATOMIC_RELAXED);
+    for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+    {
+        if ((graph->weight[e] <= run->delta) != light)
+        {
+            continue;
+        }
+        int v = graph->dest[e];
+        int64_t candidate = du + graph->weight[e];
+        if (atomicMin(run->dist, v, candidate))
+        {
+            listPush(&ring[(candidate / run->delta) % run->ringSize], v);
+            STAT_INC(relaxed);
+        }
+    }
+    return relaxed;
+}
+
+GRAPH_API void deltaWorker(void *context, int thread, int threads)
+{
+    DeltaRun *run = (DeltaRun *)context;
+    VertexList *ring = run->rings[thread];
+    VertexList settled = {NULL, 0, 0};
+    int64_t expanded = 0, scanned = 0, relaxed = 0;
+
+    for (;;)
+    {
+        int64_t bucket = run->bucket;
+        VertexList *current = &ring[bucket % run->ringSize];
+
+        // Light phase: rebuild the shared frontier from every ring until the bucket stays empty
+        for (;;)
+        {
+            run->published[thread] = current->size;
+            pthread_barrier_wait(&run->barrier);
+            if (thread == 0)
+            {
+                int64_t total = 0;
+                for (int t = 0; t < threads; t++)
+                {
+                    int64_t size = run->published[t];
+                    run->published[t] = total;
+                    total += size;
+                }
+                run->frontierSize = total;
+                run->frontier = (int *)xrealloc(run->frontier, (total ? total : 1) * sizeof(int));
+                atomic_store(&run->cursor, 0);
+            }
+            pthread_barrier_wait(&run->barrier);
+            if (run->frontierSize == 0)
+            {
+                break;
+            }
+            if (current->size > 0)
+            {
+                memcpy(run->frontier + run->published[thread], current->items, current->size * sizeof(int));
+                current->size = 0;
+            }
+            pthread_barrier_wait(&run->barrier);
+
+            for (int64_t start = atomic_fetch_add(&run->cursor, 64); start < run->frontierSize;
+                 start = atomic_fetch_add(&run->cursor, 64))
+            {
+                int64_t end = start + 64 < run->frontierSize ? start + 64 : run->frontierSize;
+                for (int64_t i = start; i < end; i++)
+                {
+                    int u = run->frontier[i];
+                    if (__atomic_load_n(&run->dist[u], __ATOMIC_RELAXED) / run->delta != bucket)
+                    {
+                        continue; // Stale entry, u already moved to a lower bucket
+                    }
+                    if (!atomic_exchange_explicit(&run->inSettled[u], true, memory_order_relaxed))
+                    {
+                        listPush(&settled, u);
+                    }
+                    STAT_ADD(relaxed, relaxEdges(run, ring, u, true));
+                    STAT_INC(expanded);
+                    STAT_ADD(scanned, run->graph->offsets[u + 1] - run->graph->offsets[u]);
+                }
+            }
+            pthread_barrier_wait(&run->barrier);
+        }
+
+        // Heavy phase: distances in this bucket are final, relax the heavy edges once
+        for (int64_t i = 0; i < settled.size; i++)
+        {
+            atomic_store_explicit(&run->inSettled[settled.items[i]], false, memory_order_relaxed);
+            STAT_ADD(relaxed, relaxEdges(run, ring, settled.items[i], false));
+        }
+        settled.size = 0;
+
+        // Agree on the next non-empty bucket across all rings
+        if (thread == 0)
+        {
+            atomic_store(&run->nextBucket, INT64_MAX);
+        }
+        pthread_barrier_wait(&run->barrier);
+        for (int64_t b = bucket + 1; b < bucket + run->ringSize; b++)
+        {
+            if (ring[b % run->ringSize].size > 0)
+            {
+                long long best = atomic_load(&run->nextBucket);
+                while (b < best && !atomic_compare_exchange_weak(&run->nextBucket, &best, b))
+                {
+                }
+                break;
+            }
+        }
+        pthread_barrier_wait(&run->barrier);
+        int64_t next = atomic_load(&run->nextBucket);
+        if (next == INT64_MAX)
+        {
+            break;
+        }
+        pthread_barrier_wait(&run->barrier); // Everyone has read nextBucket before thread 0 resets it
+        if (thread == 0)
+        {
+            run->bucket = next;
+        }
+        pthread_barrier_wait(&run->barrier);
+    }
+
+    free(settled.items);
+    // A vertex can be expanded more than once in its bucket, so this counts expansions
+    statAdd(STAT_VERTICES_SETTLED, expanded);
+    statAdd(STAT_EDGES_SCANNED, scanned);
+    statAdd(STAT_EDGES_RELAXED, relaxed);
+}
+
+// Function to find the smallest delta whose ring of maxWeight / delta + 2 buckets stays within
+// DELTA_MAX_RING
+GRAPH_API int64_t minimumDelta(const Graph *graph)
+{
+    return graph->maxWeight / (DELTA_MAX_RING - 1) + 1;
+}
+
+// Function to choose delta as the maximum weight over the average degree, at least minimumDelta
+GRAPH_API int64_t defaultDelta(const Graph *graph)
+{
+    int64_t maxWeight = graph->maxWeight > 1 ? graph->maxWeight : 1;
+    double degree = graph->V > 0 ? (double)graph->E / graph->V : 1;
+    int64_t delta = (int64_t)(maxWeight / (degree > 1 ? degree : 1));
+    return delta > minimumDelta(graph) ? delta : minimumDelta(graph);
+}
+
+// Function to compute distances from src with delta-stepping on the given number of threads
+GRAPH_API void deltaStepping(const Graph *graph, int src, int64_t delta, int threads, int64_t *dist)
+{
+    DeltaRun run;
+    run.graph = graph;
+    run.delta = delta > 0 ? delta : defaultDelta(graph);
+    run.dist = dist;
+    if (run.delta < minimumDelta(graph))
+    {
+        // Every thread keeps a ring of buckets covering the largest weight
+        printf("--delta=%lld would need %lld buckets per thread; use --delta=%lld or more.\n", (long long)run.delta,
+               (long long)(graph->maxWeight / run.delta + 2), (long long)minimumDelta(graph));
+        exit(1);
+    }
+    run.ringSize = (int)(graph->maxWeight / run.delta + 2);
+    run.inSettled = (atomic_bool *)xmalloc(graph->V * sizeof(atomic_bool));
+    run.rings = (VertexList **)xmalloc(threads * sizeof(VertexList *));
+    for (int t = 0; t < threads; t++)
+    {
+        run.rings[t] = (VertexList *)xmalloc(run.ringSize * sizeof(VertexList));
+        memset(run.rings[t], 0, run.ringSize * sizeof(VertexList));
+    }
+    run.frontier = NULL;
+    run.published = (int64_t *)xmalloc(threads * sizeof(int64_t));
+    run.bucket = 0;
+    pthread_barrier_init(&run.barrier, NULL, threads);
+
+    for (int v = 0; v < graph->V; v++)
+    {
+        dist[v] = DIST_INF;
+        atomic_init(&run.inSettled[v], false);
+    }
+    dist[src] = 0;
+    listPush(&run.rings[0][0], src);
+
+    parallelRun(threads, deltaWorker, &run);
+
+    pthread_barrier_destroy(&run.barrier);
+    for (int t = 0; t < threads; t++)
+    {
+        for (int b = 0; b < run.ringSize; b++)
+        {
+            free(run.rings[t][b].items);
+        }
+        free(run.rings[t]);
+    }
+    free(run.rings);
+    free(run.published);
+    free(run.frontier);
+    free(run.inSettled);
+}
+
+#endif // DELTA_H
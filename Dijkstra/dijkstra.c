@@ -1,216 +1,425 @@
 /**
- * @file graphs-adjacency.c
+ * @file dijkstra.c
  * @author Jorge Ricarte (jorgericartepg@gmail.com)
- * @brief A program for creating and printing the adjacency list representation of a graph.
- * @version 0.1
+ * @brief A program to find the shortest distances from a source vertex with Dijkstra's algorithm.
+ * @version 0.3
  * @date 2023-10-16
  * @copyright Copyright (c) 2023
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-
-#define INT_MAX 9999
-
-typedef struct AdjListNode
-{
-    int dest;
-    int weight; // Added weight
-    struct AdjListNode *next;
-} AdjListNode;
-
-typedef struct AdjList
-{
-	AdjListNode *head;
-} AdjList;
-
-typedef struct Graph
+#include <string.h>
+
+#include "../Common/bfs.h"
+#include "../Common/loader.h"
+#include "batch.h"
+#include "bidirectional.h"
+#include "ch.h"
+#include "delta.h"
+#include "sssp.h"
+
+// Function to print the hop counts of an unweighted search, then its level report; CSV has one
+// row per vertex and binary the V hop counts as int32, -1 for unreachable vertices
+void printHops(Graph *graph, int src, BfsSearch *bfs)
 {
-	int V;
-	char *labels;
-	AdjList *array;
-} Graph;
+    OutputFormat format = outputFormat();
+    if (format == OUTPUT_BINARY)
+    {
+        outputBytes(bfs->hops, graph->V * sizeof(int));
+        outputFlush();
+        return;
+    }
+    if (format == OUTPUT_CSV)
+    {
+        outputText("vertex,hops\n");
+    }
+    else
+    {
+        outputText("Fewest hops from vertex ");
+        outputVertex(graph, src);
+        outputText(":\n");
+    }
+    for (int i = 0; i < graph->V; i++)
+    {
+        if (format == OUTPUT_TEXT)
+        {
+            outputText("To ");
+        }
+        outputVertex(graph, i);
+        outputText(format == OUTPUT_CSV ? "," : ": ");
+        if (bfs->hops[i] < 0)
+        {
+            outputText(format == OUTPUT_CSV ? "inf" : "unreachable");
+        }
+        else
+        {
+            outputInt(bfs->hops[i]);
+        }
+        outputChar('\n');
+    }
+    outputFlush();
+    if (format == OUTPUT_TEXT)
+    {
+        printf("%lld edges examined (the graph has %lld)\n", (long long)bfs->edges, (long long)bfs->total);
+        printBfsLevels(bfs);
+    }
+}
 
-AdjListNode *newAdjListNode(int dest, int weight) // Added weight parameter
+// Function to print a point-to-point query result with its route
+void printPath(Graph *graph, int src, int dst, PathResult *result, int64_t settled)
 {
-    AdjListNode *newNode = (AdjListNode *)malloc(sizeof(AdjListNode));
-    newNode->dest = dest;
-    newNode->weight = weight; // Set the weight
-    newNode->next = NULL;
-    return newNode;
+    printf("Shortest path from ");
+    printVertex(graph, src);
+    printf(" to ");
+    printVertex(graph, dst);
+    if (result->distance == DIST_INF)
+    {
+        printf(": unreachable\n");
+    }
+    else
+    {
+        printf(": %lld\n", (long long)result->distance);
+        printf("Path: ");
+        for (int i = 0; i < result->length; i++)
+        {
+            printVertex(graph, result->path[i]);
+            printf(i + 1 < result->length ? " -> " : "\n");
+        }
+    }
+    printf("Settled %lld of %d vertices\n", (long long)settled, graph->V);
 }
 
-void addEdge(Graph *graph, int src, int dest, int weight) // Added weight parameter
+void usage(char *program)
 {
-    AdjListNode *newNode = newAdjListNode(dest, weight);
-    newNode->next = graph->array[src].head;
-    graph->array[src].head = newNode;
+    printf("Usage: %s <file1> <source_vertex> [--engine=auto|heap|array|delta|dial|radix|01bfs|bfs] [--delta=N] [--threads=N]\n", program);
+    printf("       %s <file1> <source_vertex> [--hops] [--quiet] [--output=text|csv|binary]\n", program);
+    printf("       %s <file1> <source_vertex> --target=<vertex>\n", program);
+    printf("       %s <file1> --sources=<v1,v2,...>|--all [--threads=N] [--matrix=<file>] [--engine=...]\n", program);
+    printf("       %s <file1> --ch-build=<index>\n", program);
+    printf("       %s <index> <source_vertex> --target=<vertex> | %s <index> --queries=N\n", program, program);
+    printf("--quiet skips the adjacency dump; csv and binary output hold the distances or hops alone.\n");
+    printf("Every form also takes --stats[=FILE] to report phase times and counters as JSON.\n");
+    exit(1);
 }
 
-Graph *createGraph(char *fileName)
+// Function to parse a comma-separated list of vertex names or numbers
+int *parseSources(char *list, const Graph *graph, int *count)
 {
-	// Open the input file
-	FILE *file = fopen(fileName, "r");
-	if (file == NULL)
-	{
-		printf("Erro ao abrir o arquivo.\n");
-		exit(1);
-	}
-
-	// Read the first line to determine the number of vertices
-	char line[100];
-	fgets(line, sizeof(line), file);
-
-	int V = 0;
-	for (int i = 0; line[i] != '\0'; ++i)
-	{
-		if (line[i] != ' ' && line[i] != '\n' && line[i] != '\r')
-		{
-			++V;
-		}
-	}
-
-	char vertexLabels[V];
-	for (int i = 0, j = 0; line[i] != '\0'; ++i)
-	{
-		if (line[i] != ' ' && line[i] != '\n' && line[i] != '\r')
-		{
-			vertexLabels[j] = line[i];
-			++j;
-		}
-	}
-
-	// Allocate memory for the graph structure
-	Graph *graph = (Graph *)malloc(sizeof(Graph));
-	graph->V = V;
-	graph->labels = (char *)malloc(V * sizeof(char));
-	// ... Initializing adjacency lists ...
-	for (int i = 0; i < V; ++i)
-	{
-		graph->labels[i] = vertexLabels[i];
-	}
-
-	graph->array = (AdjList *)malloc(V * sizeof(AdjList));
-	for (int i = 0; i < V; ++i)
-	{
-		graph->array[i].head = NULL;
-	}
-
-    for (int i = 0; i < V; ++i)
-    {
-        for (int j = 0; j < V; ++j)
+    int *sources = (int *)xmalloc((strlen(list) / 2 + 1) * sizeof(int));
+    *count = 0;
+    for (char *token = strtok(list, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        int v = findVertex(graph, token);
+        if (v < 0)
         {
-            int weight;
-            fscanf(file, "%d", &weight);
-
-            // If the weight is not 0, add an edge between vertices i and j
-            if (weight != 0)
-            {
-                addEdge(graph, i, j, weight); // Added weight parameter
-            }
+            printf("Source vertex must be %sbetween 0 and %d.\n", graph->labels != NULL ? "a vertex name or " : "",
+                   graph->V - 1);
+            exit(1);
         }
+        sources[(*count)++] = v;
     }
+    return sources;
+}
 
-	fclose(file);
-	return graph;
+// Function to read a vertex number of the index; -1 unless the whole text is a number in range
+int hierarchyVertex(const ContractionHierarchy *ch, const char *text)
+{
+    char *end;
+    long v = strtol(text, &end, 10);
+    return end != text && *end == '\0' && v >= 0 && v < ch->V ? (int)v : -1;
 }
 
-// Function to print the adjacency list representation of the graph
-void printGraph(Graph *graph)
+// Function to answer queries from a contraction hierarchy index, one pair or N random pairs
+int queryHierarchy(char *file, char *source, char *target, int queries)
 {
-    for (int v = 0; v < graph->V; ++v)
+    double start = nowSeconds();
+    statInput(file);
+    statPhase(PHASE_PARSE);
+    ContractionHierarchy *ch = loadHierarchy(file);
+    statPhase(PHASE_OUTPUT);
+    printf("Loaded hierarchy of %d vertices (%lld shortcuts) in %.3f ms\n", ch->V, (long long)ch->shortcuts,
+           (nowSeconds() - start) * 1e3);
+    ChQuery query;
+    initChQuery(&query, ch->V);
+
+    if (queries == 0)
     {
-        printf("Adjacencies of vertex %c: ", graph->labels[v]);
-        AdjListNode *current = graph->array[v].head;
-        while (current != NULL)
+        // The index keeps no labels, so only vertex numbers can be looked up
+        int src = hierarchyVertex(ch, source);
+        int dst = hierarchyVertex(ch, target);
+        if (src < 0 || dst < 0)
         {
-            printf("%c (%d) -> ", graph->labels[current->dest], current->weight); // Print the weight
-            current = current->next;
+            printf("%s vertex must be between 0 and %d.\n", src < 0 ? "Source" : "Target", ch->V - 1);
+            exit(1);
         }
-        printf("NULL\n");
+        statPhase(PHASE_COMPUTE);
+        start = nowSeconds();
+        int64_t distance = chDistance(ch, src, dst, &query);
+        double elapsed = nowSeconds() - start;
+        statPhase(PHASE_OUTPUT);
+        if (distance == DIST_INF)
+        {
+            printf("Shortest distance from %d to %d: unreachable\n", src, dst);
+        }
+        else
+        {
+            printf("Shortest distance from %d to %d: %lld\n", src, dst, (long long)distance);
+        }
+        printf("Settled %lld of %d vertices in %.1f us\n", (long long)query.settled, ch->V, elapsed * 1e6);
     }
-}
-
-// Function to find the minimum distance vertex not yet included in the shortest path tree
-int minDistance(int dist[], bool sptSet[], int V)
-{
-    int min = INT_MAX, min_index;
-
-    for (int v = 0; v < V; v++)
+    else
     {
-        if (!sptSet[v] && dist[v] < min)
+        // Fixed seed so runs are comparable
+        uint64_t seed = 88172645463325252ull;
+        int64_t settled = 0;
+        int reached = 0;
+        statPhase(PHASE_COMPUTE);
+        start = nowSeconds();
+        for (int i = 0; i < queries; i++)
         {
-            min = dist[v];
-            min_index = v;
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            int src = (int)(seed % (uint64_t)ch->V);
+            int dst = (int)((seed >> 32) % (uint64_t)ch->V);
+            reached += chDistance(ch, src, dst, &query) != DIST_INF;
+            settled += query.settled;
         }
+        double elapsed = nowSeconds() - start;
+        statPhase(PHASE_OUTPUT);
+        printf("%d random queries (%d reachable): %.2f us per query, %.1f vertices settled per query\n",
+               queries, reached, elapsed * 1e6 / queries, (double)settled / queries);
     }
 
-    return min_index;
+    freeChQuery(&query);
+    freeHierarchy(ch);
+    return 0;
 }
 
-// Function to implement Dijkstra's algorithm
-void dijkstra(Graph *graph, int src)
+int main(int argc, char *argv[])
 {
-    int V = graph->V;
-    int dist[V];
-    bool sptSet[V];
+    char *file = NULL;
+    char *source = NULL;
+    SsspEngine engine = SSSP_AUTO;
+    char *sourceList = NULL;
+    bool allSources = false;
+    int threads = defaultThreadCount();
+    char *matrixFile = NULL;
+    int64_t delta = 0; // 0 lets deltaStepping pick it
+    char *target = NULL;
+    char *chBuild = NULL;
+    int queries = 0;
+    bool hops = false;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--engine=", 9) == 0)
+        {
+            char *name = argv[i] + 9;
+            if (strcmp(name, "auto") == 0)
+                engine = SSSP_AUTO;
+            else if (strcmp(name, "heap") == 0)
+                engine = SSSP_HEAP;
+            else if (strcmp(name, "array") == 0)
+                engine = SSSP_ARRAY;
+            else if (strcmp(name, "delta") == 0)
+                engine = SSSP_DELTA;
+            else if (strcmp(name, "dial") == 0)
+                engine = SSSP_DIAL;
+            else if (strcmp(name, "radix") == 0)
+                engine = SSSP_RADIX;
+            else if (strcmp(name, "01bfs") == 0)
+                engine = SSSP_ZERO_ONE;
+            else if (strcmp(name, "bfs") == 0)
+                engine = SSSP_BFS;
+            else
+                usage(argv[0]);
+        }
+        else if (strncmp(argv[i], "--sources=", 10) == 0)
+            sourceList = argv[i] + 10;
+        else if (strcmp(argv[i], "--all") == 0)
+            allSources = true;
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+            threads = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--matrix=", 9) == 0)
+            matrixFile = argv[i] + 9;
+        else if (strncmp(argv[i], "--target=", 9) == 0)
+            target = argv[i] + 9;
+        else if (strncmp(argv[i], "--delta=", 8) == 0)
+            delta = atoll(argv[i] + 8);
+        else if (strncmp(argv[i], "--ch-build=", 11) == 0)
+            chBuild = argv[i] + 11;
+        else if (strncmp(argv[i], "--queries=", 10) == 0)
+            queries = atoi(argv[i] + 10);
+        else if (strcmp(argv[i], "--hops") == 0)
+            hops = true;
+        else if (strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else if (outputOption(argv[i]))
+            continue;
+        else if (statsOption(argv[i], argv[0]))
+            continue;
+        else if (file == NULL)
+            file = argv[i];
+        else if (source == NULL)
+            source = argv[i];
+        else
+            usage(argv[0]);
+    }
+    // Query mode: the file is a prebuilt contraction hierarchy
+    if (file != NULL && isHierarchyFile(file))
+    {
+        if (outputFormat() != OUTPUT_TEXT || queries < 0 || (queries == 0) == (source == NULL || target == NULL) || (queries > 0 && source != NULL))
+        {
+            usage(argv[0]);
+        }
+        return queryHierarchy(file, source, target, queries);
+    }
 
-    for (int i = 0; i < V; i++)
+    bool batch = sourceList != NULL || allSources;
+    bool noSource = batch || chBuild != NULL;
+    if (file == NULL || (source == NULL) == !noSource || (batch && chBuild != NULL) || (chBuild != NULL && target != NULL) || threads < 1 || delta < 0 || (batch && engine == SSSP_DELTA) || (batch && target != NULL) || (hops && (noSource || target != NULL)) || (outputFormat() != OUTPUT_TEXT && (noSource || target != NULL)))
     {
-        dist[i] = INT_MAX;
-        sptSet[i] = false;
+        usage(argv[0]);
     }
 
-    dist[src] = 0;
+    Graph *graph = createGraph(file);
+    if (hasNegativeWeight(graph))
+    {
+        printf("Dijkstra's algorithm needs non-negative edge weights.\n");
+        return 1;
+    }
+    if ((engine == SSSP_BFS && graph->E > 0 && (graph->minWeight != 1 || graph->maxWeight != 1)) ||
+        (engine == SSSP_ZERO_ONE && graph->maxWeight > 1))
+    {
+        printf("The %s engine needs every edge weight to be %s.\n", engine == SSSP_BFS ? "bfs" : "01bfs",
+               engine == SSSP_BFS ? "1" : "0 or 1");
+        return 1;
+    }
+    if (engine == SSSP_DELTA && delta > 0 && delta < minimumDelta(graph))
+    {
+        printf("--delta=%lld would need %lld buckets per thread; use --delta=%lld or more.\n", (long long)delta,
+               (long long)(graph->maxWeight / delta + 2), (long long)minimumDelta(graph));
+        return 1;
+    }
+    if (engine == SSSP_DIAL && graph->maxWeight > DIAL_LIMIT)
+    {
+        printf("The dial engine keeps a bucket per weight up to %d; use radix for larger weights.\n", DIAL_LIMIT);
+        return 1;
+    }
 
-    for (int count = 0; count < V - 1; count++)
+    // Preprocessing mode: contract the graph once and save the index for later queries
+    if (chBuild != NULL)
     {
-        int u = minDistance(dist, sptSet, V);
-        sptSet[u] = true;
+        statPhase(PHASE_COMPUTE);
+        double start = nowSeconds();
+        ContractionHierarchy *ch = buildHierarchy(graph);
+        double elapsed = nowSeconds() - start;
+        statPhase(PHASE_OUTPUT);
+        uint64_t size = writeHierarchy(ch, chBuild);
+        printf("Contracted %d vertices in %.3f s: %lld edges, %lld shortcuts\n", graph->V, elapsed,
+               (long long)graph->E, (long long)ch->shortcuts);
+        printf("Index %s: %llu bytes, %lld upward and %lld downward arcs\n", chBuild, (unsigned long long)size,
+               (long long)ch->upOffsets[ch->V], (long long)ch->downOffsets[ch->V]);
+        freeHierarchy(ch);
+        freeGraph(graph);
+        return 0;
+    }
 
-        AdjListNode *current = graph->array[u].head;
-        while (current != NULL)
+    // Batch mode: one row of distances per source, computed on a pool of threads
+    if (batch)
+    {
+        int count = graph->V;
+        int *sources = allSources ? (int *)xmalloc(graph->V * sizeof(int)) : parseSources(sourceList, graph, &count);
+        for (int v = 0; allSources && v < graph->V; v++)
         {
-            int v = current->dest;
-            if (!sptSet[v] && dist[u] != INT_MAX && dist[u] + current->weight < dist[v])
-            {
-                dist[v] = dist[u] + current->weight;
-            }
-            current = current->next;
+            sources[v] = v;
         }
+        statPhase(PHASE_COMPUTE);
+        dijkstraBatch(graph, sources, count, engine, threads, matrixFile);
+        free(sources);
+        freeGraph(graph);
+        return 0;
     }
 
-    printf("Shortest distances from vertex %c:\n", graph->labels[src]);
-    for (int i = 0; i < V; i++)
+    int source_vertex = findVertex(graph, source); // Get the source vertex from the command line argument
+    if (source_vertex < 0)
     {
-        printf("To %c: %d\n", graph->labels[i], dist[i]);
+        printf("Source vertex must be %sbetween 0 and %d.\n", graph->labels != NULL ? "a vertex name or " : "",
+               graph->V - 1);
+        return 1;
     }
-}
-
 
-int main(int argc, char *argv[])
-{
-    if (argc != 3)
+    statPhase(PHASE_OUTPUT);
+    if (!quiet && outputFormat() == OUTPUT_TEXT)
     {
-        printf("Usage: %s <file1> <source_vertex>\n", argv[0]);
-        return 1;
+        printAdjacency(graph, true);
     }
 
-    char *file = argv[1];
-    Graph *graph = createGraph(file);
-    int source_vertex = atoi(argv[2]); // Get the source vertex from the command line argument
-
-    printf("Graph:\n");
-    printf("Vertex labels: %s\n", graph->labels);
+    // Hop mode: weights are ignored and a direction-optimizing BFS counts the fewest edges
+    if (hops)
+    {
+        const Graph *reverse = isSymmetric(graph) ? graph : transposeGraph(graph);
+        BfsSearch bfs;
+        initBfs(&bfs, graph);
+        statPhase(PHASE_COMPUTE);
+        bfsFrom(graph, reverse, source_vertex, &bfs);
+        statPhase(PHASE_OUTPUT);
+        printHops(graph, source_vertex, &bfs);
+
+        freeBfs(&bfs);
+        if (reverse != graph)
+        {
+            freeGraph((Graph *)reverse);
+        }
+        freeGraph(graph);
+        return 0;
+    }
 
-    printGraph(graph);
+    // Point-to-point mode: bidirectional search that stops when the frontiers meet
+    if (target != NULL)
+    {
+        int target_vertex = findVertex(graph, target);
+        if (target_vertex < 0)
+        {
+            printf("Target vertex must be %sbetween 0 and %d.\n", graph->labels != NULL ? "a vertex name or " : "",
+                   graph->V - 1);
+            return 1;
+        }
+        statPhase(PHASE_COMPUTE);
+        Graph *reverse = transposeGraph(graph);
+        BidirectionalSearch search;
+        initBidirectional(&search, graph->V);
+        PathResult result = bidirectionalDijkstra(graph, reverse, source_vertex, target_vertex, &search);
+        statPhase(PHASE_OUTPUT);
+        printPath(graph, source_vertex, target_vertex, &result, search.settled);
+
+        free(result.path);
+        freeBidirectional(&search);
+        freeGraph(reverse);
+        freeGraph(graph);
+        return 0;
+    }
 
-    dijkstra(graph, source_vertex);
+    SsspWorkspace ws;
+    initWorkspace(&ws, graph->V);
+    statPhase(PHASE_COMPUTE);
+    if (engine == SSSP_DELTA)
+    {
+        deltaStepping(graph, source_vertex, delta, threads, ws.dist);
+    }
+    else
+    {
+        dijkstra(graph, source_vertex, engine, &ws);
+    }
+    statPhase(PHASE_OUTPUT);
+    printDistances(graph, source_vertex, &ws);
 
     // Free memory
-    free(graph->labels);
-    free(graph->array);
-    free(graph);
+    freeWorkspace(&ws);
+    freeGraph(graph);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,468 @@
+/**
+ * @file sssp.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Single-source shortest path engines used by the Dijkstra tool.
+ * @version 0.1
+ * @date 2023-10-16
+ * @copyright Copyright (c) 2023
+ *
+ * SSSP_ARRAY is the original O(V^2) scan, still the fastest choice on dense matrices.
+ * SSSP_HEAP keeps the frontier in an indexed 4-ary heap and runs in O((V + E) log V).
+ * SSSP_DELTA is the parallel delta-stepping engine of delta.h.
+ * The integer engines use what the weights are, as seen when the graph was loaded:
+ * SSSP_BFS is a FIFO search for graphs whose weights are all 1, SSSP_ZERO_ONE a 0-1 BFS that
+ * puts 0-edges at the front of a deque, SSSP_DIAL keeps maxWeight + 1 circular buckets and
+ * SSSP_RADIX a radix heap for larger weights (buckets.h). All of them run in O(V + E) plus,
+ * for Dial, the buckets walked up to the largest distance.
+ */
+#ifndef SSSP_H
+#define SSSP_H
+
+#include "../Common/graph.h"
+#include "../Common/buckets.h"
+#include "../Common/heap.h"
+
+// Distance of a vertex that cannot be reached from the source
+#define DIST_INF INT64_MAX
+
+typedef enum SsspEngine
+{
+    SSSP_AUTO,
+    SSSP_ARRAY,
+    SSSP_HEAP,
+    SSSP_DELTA,
+    SSSP_BFS,
+    SSSP_ZERO_ONE,
+    SSSP_DIAL,
+    SSSP_RADIX
+} SsspEngine;
+
+// Largest edge weight for which SSSP_AUTO keeps Dial's buckets rather than the radix heap
+#define DIAL_MAX_WEIGHT (1 << 14)
+// Largest edge weight SSSP_DIAL accepts at all: one 4-byte bucket head per possible weight
+#define DIAL_LIMIT (1 << 26)
+
+// Per-run state, kept outside the Graph so it can be reused between sources
+typedef struct SsspWorkspace
+{
+    int V;
+    int64_t *dist;
+    bool *settled;
+    IndexedHeap heap;
+    BucketQueue buckets;   // The structures below are allocated by the first run that needs them
+    RadixHeap radix;
+    int *queue;            // FIFO of SSSP_BFS, deque of SSSP_ZERO_ONE
+} SsspWorkspace;
+
+GRAPH_API void initWorkspace(SsspWorkspace *ws, int V)
+{
+    ws->V = V;
+    ws->dist = (int64_t *)xmalloc(V * sizeof(int64_t));
+    ws->settled = (bool *)xmalloc(V * sizeof(bool));
+    initHeap(&ws->heap, V);
+    memset(&ws->buckets, 0, sizeof(ws->buckets));
+    initRadixHeap(&ws->radix);
+    ws->queue = NULL;
+}
+
+GRAPH_API void freeWorkspace(SsspWorkspace *ws)
+{
+    free(ws->dist);
+    free(ws->settled);
+    freeHeap(&ws->heap);
+    freeBucketQueue(&ws->buckets);
+    freeRadixHeap(&ws->radix);
+    free(ws->queue);
+}
+
+// Function to pick an engine from the weight range: a BFS when every weight is 1 or at most
+// 1, Dial's buckets for small weights, otherwise the array scan when the graph is so dense that
+// heap operations cost more, and the radix heap when it is not
+GRAPH_API SsspEngine chooseEngine(const Graph *graph)
+{
+    if (graph->minWeight == 1 && graph->maxWeight == 1)
+    {
+        return SSSP_BFS;
+    }
+    if (graph->maxWeight <= 1)
+    {
+        return SSSP_ZERO_ONE;
+    }
+    if (graph->maxWeight <= DIAL_MAX_WEIGHT)
+    {
+        return SSSP_DIAL;
+    }
+    int logV = 1;
+    while ((1 << logV) < graph->V)
+    {
+        logV++;
+    }
+    return (double)graph->E * logV > (double)graph->V * graph->V ? SSSP_ARRAY : SSSP_RADIX;
+}
+
+// Function to find the minimum distance vertex not yet included in the shortest path tree
+GRAPH_API int minDistance(const int64_t dist[], const bool sptSet[], int V)
+{
+    int64_t min = DIST_INF;
+    int min_index = -1;
+
+    for (int v = 0; v < V; v++)
+    {
+        if (!sptSet[v] && dist[v] < min)
+        {
+            min = dist[v];
+            min_index = v;
+        }
+    }
+
+    return min_index;
+}
+
+// Function to implement Dijkstra's algorithm with the O(V^2) array scan
+GRAPH_API void dijkstraArray(const Graph *graph, int src, SsspWorkspace *ws)
+{
+    int V = graph->V;
+    int64_t *dist = ws->dist;
+    bool *sptSet = ws->settled;
+
+    for (int i = 0; i < V; i++)
+    {
+        dist[i] = DIST_INF;
+        sptSet[i] = false;
+    }
+
+    dist[src] = 0;
+
+    int64_t settled = 0, scanned = 0, relaxed = 0;
+    for (int count = 0; count < V; count++)
+    {
+        int u = minDistance(dist, sptSet, V);
+        if (u < 0)
+        {
+            break; // Every remaining vertex is unreachable
+        }
+        sptSet[u] = true;
+        STAT_INC(settled);
+        STAT_ADD(scanned, graph->offsets[u + 1] - graph->offsets[u]);
+
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+        {
+            int v = graph->dest[e];
+            if (!sptSet[v] && dist[u] + graph->weight[e] < dist[v])
+            {
+                dist[v] = dist[u] + graph->weight[e];
+                STAT_INC(relaxed);
+            }
+        }
+    }
+    // Every scan looks at all V vertices, including the last one that finds nothing
+    statAdd(STAT_MIN_SCAN_STEPS, (settled + (settled < V)) * V);
+    statAdd(STAT_VERTICES_SETTLED, settled);
+    statAdd(STAT_EDGES_SCANNED, scanned);
+    statAdd(STAT_EDGES_RELAXED, relaxed);
+}
+
+// Function to implement Dijkstra's algorithm with an indexed heap and decrease-key
+GRAPH_API void dijkstraHeap(const Graph *graph, int src, SsspWorkspace *ws)
+{
+    int64_t *dist = ws->dist;
+    IndexedHeap *heap = &ws->heap;
+
+    for (int i = 0; i < graph->V; i++)
+    {
+        dist[i] = DIST_INF;
+    }
+    clearHeap(heap);
+
+    dist[src] = 0;
+    heapPushOrDecrease(heap, src, 0);
+
+    int64_t settled = 0, scanned = 0, relaxed = 0;
+    while (!heapEmpty(heap))
+    {
+        int u = heapPop(heap);
+        int64_t du = dist[u];
+        STAT_INC(settled);
+        STAT_ADD(scanned, graph->offsets[u + 1] - graph->offsets[u]);
+
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+        {
+            int v = graph->dest[e];
+            int64_t candidate = du + graph->weight[e];
+            if (candidate < dist[v])
+            {
+                dist[v] = candidate;
+                heapPushOrDecrease(heap, v, candidate);
+                STAT_INC(relaxed);
+            }
+        }
+    }
+    statAdd(STAT_VERTICES_SETTLED, settled);
+    statAdd(STAT_EDGES_SCANNED, scanned);
+    statAdd(STAT_EDGES_RELAXED, relaxed);
+    publishHeapStats(heap);
+}
+
+// Function to reset the distances for a run from src
+GRAPH_API void startRun(const Graph *graph, int src, int64_t *dist)
+{
+    for (int i = 0; i < graph->V; i++)
+    {
+        dist[i] = DIST_INF;
+    }
+    dist[src] = 0;
+}
+
+// Function to find the shortest paths when every weight is 1: the order of a FIFO search
+GRAPH_API void dijkstraBfs(const Graph *graph, int src, SsspWorkspace *ws)
+{
+    int64_t *dist = ws->dist;
+    if (ws->queue == NULL)
+    {
+        ws->queue = (int *)xmalloc((2 * (int64_t)graph->V + 2) * sizeof(int));
+    }
+    int *queue = ws->queue;
+    startRun(graph, src, dist);
+
+    int head = 0, tail = 0;
+    queue[tail++] = src;
+    int64_t scanned = 0, relaxed = 0;
+    while (head < tail)
+    {
+        int u = queue[head++];
+        int64_t next = dist[u] + 1;
+        STAT_ADD(scanned, graph->offsets[u + 1] - graph->offsets[u]);
+
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+        {
+            int v = graph->dest[e];
+            if (dist[v] == DIST_INF)
+            {
+                dist[v] = next;
+                queue[tail++] = v;
+                STAT_INC(relaxed);
+            }
+        }
+    }
+    statAdd(STAT_VERTICES_SETTLED, tail);
+    statAdd(STAT_EDGES_SCANNED, scanned);
+    statAdd(STAT_EDGES_RELAXED, relaxed);
+}
+
+// Function to find the shortest paths when every weight is 0 or 1: a vertex reached through a
+// 0-edge goes to the front of the deque, through a 1-edge to the back, so the deque stays
+// sorted. A vertex is pushed again only when a 0-edge lowers it by one, so the ring never
+// holds more than 2V entries.
+GRAPH_API void dijkstraZeroOne(const Graph *graph, int src, SsspWorkspace *ws)
+{
+    int64_t *dist = ws->dist;
+    bool *settled = ws->settled;
+    int64_t size = 2 * (int64_t)graph->V + 2;
+    if (ws->queue == NULL)
+    {
+        ws->queue = (int *)xmalloc(size * sizeof(int));
+    }
+    int *deque = ws->queue;
+    startRun(graph, src, dist);
+    memset(settled, 0, graph->V * sizeof(bool));
+
+    int64_t front = 0, back = 0; // Entries are front .. back - 1, modulo size
+    deque[back++] = src;
+    int64_t count = 0, scanned = 0, relaxed = 0;
+    while (front != back)
+    {
+        int u = deque[front];
+        front = front + 1 == size ? 0 : front + 1;
+        if (settled[u])
+        {
+            continue; // Pushed a second time, and already expanded from the first entry
+        }
+        settled[u] = true;
+        STAT_INC(count);
+        STAT_ADD(scanned, graph->offsets[u + 1] - graph->offsets[u]);
+
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+        {
+            int v = graph->dest[e];
+            int64_t candidate = dist[u] + graph->weight[e];
+            if (candidate < dist[v])
+            {
+                dist[v] = candidate;
+                STAT_INC(relaxed);
+                if (graph->weight[e] == 0)
+                {
+                    front = front == 0 ? size - 1 : front - 1;
+                    deque[front] = v;
+                }
+                else
+                {
+                    deque[back] = v;
+                    back = back + 1 == size ? 0 : back + 1;
+                }
+            }
+        }
+    }
+    statAdd(STAT_VERTICES_SETTLED, count);
+    statAdd(STAT_EDGES_SCANNED, scanned);
+    statAdd(STAT_EDGES_RELAXED, relaxed);
+}
+
+// Function to implement Dial's algorithm: Dijkstra with maxWeight + 1 circular buckets
+GRAPH_API void dijkstraDial(const Graph *graph, int src, SsspWorkspace *ws)
+{
+    int64_t *dist = ws->dist;
+    BucketQueue *buckets = &ws->buckets;
+    if (buckets->width <= graph->maxWeight)
+    {
+        freeBucketQueue(buckets);
+        initBucketQueue(buckets, graph->V, graph->maxWeight);
+    }
+    clearBucketQueue(buckets);
+    startRun(graph, src, dist);
+    bucketPushOrDecrease(buckets, src, 0);
+
+    int64_t settled = 0, scanned = 0, relaxed = 0;
+    while (!bucketEmpty(buckets))
+    {
+        int64_t du;
+        int u = bucketPop(buckets, &du);
+        STAT_INC(settled);
+        STAT_ADD(scanned, graph->offsets[u + 1] - graph->offsets[u]);
+
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+        {
+            int v = graph->dest[e];
+            int64_t candidate = du + graph->weight[e];
+            if (candidate < dist[v])
+            {
+                dist[v] = candidate;
+                bucketPushOrDecrease(buckets, v, candidate);
+                STAT_INC(relaxed);
+            }
+        }
+    }
+    statAdd(STAT_VERTICES_SETTLED, settled);
+    statAdd(STAT_EDGES_SCANNED, scanned);
+    statAdd(STAT_EDGES_RELAXED, relaxed);
+    publishBucketStats(buckets);
+}
+
+// Function to implement Dijkstra's algorithm with a radix heap; instead of decreasing a key it
+// pushes the vertex again and skips the entries that no longer match its distance
+GRAPH_API void dijkstraRadix(const Graph *graph, int src, SsspWorkspace *ws)
+{
+    int64_t *dist = ws->dist;
+    RadixHeap *heap = &ws->radix;
+    clearRadixHeap(heap);
+    startRun(graph, src, dist);
+    radixPush(heap, src, 0);
+
+    int64_t settled = 0, scanned = 0, relaxed = 0;
+    while (!radixEmpty(heap))
+    {
+        int64_t du;
+        int u = radixPop(heap, &du);
+        if (du != dist[u])
+        {
+            continue;
+        }
+        STAT_INC(settled);
+        STAT_ADD(scanned, graph->offsets[u + 1] - graph->offsets[u]);
+
+        for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+        {
+            int v = graph->dest[e];
+            int64_t candidate = du + graph->weight[e];
+            if (candidate < dist[v])
+            {
+                dist[v] = candidate;
+                radixPush(heap, v, candidate);
+                STAT_INC(relaxed);
+            }
+        }
+    }
+    statAdd(STAT_VERTICES_SETTLED, settled);
+    statAdd(STAT_EDGES_SCANNED, scanned);
+    statAdd(STAT_EDGES_RELAXED, relaxed);
+    publishRadixStats(heap);
+}
+
+// Function to run the selected engine, leaving the distances in ws->dist
+GRAPH_API void dijkstra(const Graph *graph, int src, SsspEngine engine, SsspWorkspace *ws)
+{
+    if (engine == SSSP_AUTO)
+    {
+        engine = chooseEngine(graph);
+    }
+    switch (engine)
+    {
+    case SSSP_ARRAY:
+        dijkstraArray(graph, src, ws);
+        break;
+    case SSSP_BFS:
+        dijkstraBfs(graph, src, ws);
+        break;
+    case SSSP_ZERO_ONE:
+        dijkstraZeroOne(graph, src, ws);
+        break;
+    case SSSP_DIAL:
+        dijkstraDial(graph, src, ws);
+        break;
+    case SSSP_RADIX:
+        dijkstraRadix(graph, src, ws);
+        break;
+    default:
+        dijkstraHeap(graph, src, ws);
+        break;
+    }
+}
+
+// Function to check the precondition of every engine: no negative edge weights
+GRAPH_API bool hasNegativeWeight(const Graph *graph)
+{
+    return graph->minWeight < 0;
+}
+
+// Function to print the distances left in the workspace by dijkstra(): one line per vertex as
+// text or CSV, or the V distances as binary int64 (DIST_INF for unreachable vertices)
+GRAPH_API void printDistances(const Graph *graph, int src, const SsspWorkspace *ws)
+{
+    OutputFormat format = outputFormat();
+    if (format == OUTPUT_BINARY)
+    {
+        outputBytes(ws->dist, graph->V * sizeof(int64_t));
+        outputFlush();
+        return;
+    }
+    if (format == OUTPUT_CSV)
+    {
+        outputText("vertex,distance\n");
+    }
+    else
+    {
+        outputText("Shortest distances from vertex ");
+        outputVertex(graph, src);
+        outputText(":\n");
+    }
+    for (int i = 0; i < graph->V; i++)
+    {
+        if (format == OUTPUT_TEXT)
+        {
+            outputText("To ");
+        }
+        outputVertex(graph, i);
+        outputText(format == OUTPUT_CSV ? "," : ": ");
+        if (ws->dist[i] == DIST_INF)
+        {
+            outputText(format == OUTPUT_CSV ? "inf" : "unreachable");
+        }
+        else
+        {
+            outputInt(ws->dist[i]);
+        }
+        outputChar('\n');
+    }
+    outputFlush();
+}
+
+#endif // SSSP_H
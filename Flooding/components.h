@@ -0,0 +1,282 @@
+/**
+ * @file components.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Connected components on a concurrent union-find, following Afforest.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Edges are read as undirected, so directed inputs get their weakly connected components.
+ * First every vertex is linked to its first two neighbours, which already merges most of
+ * a typical graph into one big component. That component is found by sampling, and in the
+ * final pass its vertices skip their remaining edges: each of those edges is also seen from
+ * its other end, which links it if it matters. The skip is only safe on symmetric graphs,
+ * and checking symmetry costs several times more than linking every edge, so the caller
+ * says whether the graph is symmetric; otherwise every remaining edge is scanned. Nothing
+ * recurses, so long paths cost no stack.
+ */
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "../Common/bfs.h"
+#include "../Common/bitset.h"
+#include "../Common/parallel.h"
+#include "../Common/unionfind.h"
+
+#define CC_NEIGHBOUR_ROUNDS 2
+#define CC_SAMPLES 1024
+
+typedef struct Components {
+    int V;
+    int count;                 // Components, isolated vertices included
+    int isolated;              // Vertices without any edge
+    int *id;                   // Component of each vertex, numbered in order of smallest vertex
+    int *size;                 // Vertices in each component
+} Components;
+
+typedef struct ComponentsRun {
+    int V;
+    const Graph *graph;        // NULL when the edges were streamed into the union-find
+    const bool *hasEdge;       // Vertices seen in a streamed edge
+    UnionFind uf;
+    int skip;                  // Root whose vertices skip the final pass, or -1
+    int *roots;                // Roots counted by each thread, then the first id of each thread
+    Components *result;
+} ComponentsRun;
+
+// Phase 1: link every vertex to its first neighbours
+GRAPH_API void linkNeighbours(void *context, int thread, int threads) {
+    ComponentsRun *run = (ComponentsRun *)context;
+    const Graph *graph = run->graph;
+    int64_t begin, end;
+    parallelBlock(graph->V, thread, threads, &begin, &end);
+    int64_t scanned = 0;
+    for (int64_t u = begin; u < end; ++u) {
+        int64_t last = graph->offsets[u] + CC_NEIGHBOUR_ROUNDS;
+        last = last < graph->offsets[u + 1] ? last : graph->offsets[u + 1];
+        STAT_ADD(scanned, last - graph->offsets[u]);
+        for (int64_t e = graph->offsets[u]; e < last; ++e) {
+            ufUnion(&run->uf, (int)u, graph->dest[e]);
+        }
+    }
+    statAdd(STAT_EDGES_SCANNED, scanned);
+}
+
+// Phase 2: link the remaining edges of every vertex outside the big component
+GRAPH_API void linkRemaining(void *context, int thread, int threads) {
+    ComponentsRun *run = (ComponentsRun *)context;
+    const Graph *graph = run->graph;
+    int64_t begin, end;
+    parallelBlock(graph->V, thread, threads, &begin, &end);
+    int64_t scanned = 0;
+    for (int64_t u = begin; u < end; ++u) {
+        if (run->skip >= 0 && ufFind(&run->uf, (int)u) == run->skip) {
+            continue;
+        }
+        for (int64_t e = graph->offsets[u] + CC_NEIGHBOUR_ROUNDS; e < graph->offsets[u + 1]; ++e) {
+            ufUnion(&run->uf, (int)u, graph->dest[e]);
+            STAT_INC(scanned);
+        }
+    }
+    statAdd(STAT_EDGES_SCANNED, scanned);
+}
+
+// Function to guess the root of the biggest component from a sample of vertices
+GRAPH_API int sampleBigRoot(ComponentsRun *run) {
+    int V = run->graph->V;
+    int samples = V < CC_SAMPLES ? V : CC_SAMPLES;
+    int *roots = (int *)xmalloc((samples > 0 ? samples : 1) * sizeof(int));
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+    for (int i = 0; i < samples; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        roots[i] = ufFind(&run->uf, (int)(seed % (uint64_t)V));
+    }
+    // Majority vote (Boyer-Moore): a component holding most of the graph wins
+    int best = -1;
+    int votes = 0;
+    for (int i = 0; i < samples; ++i) {
+        if (votes == 0) {
+            best = roots[i];
+        }
+        votes += roots[i] == best ? 1 : -1;
+    }
+    free(roots);
+    return best;
+}
+
+// Phase 3: point every vertex at its root and count the roots of each block
+GRAPH_API void countRoots(void *context, int thread, int threads) {
+    ComponentsRun *run = (ComponentsRun *)context;
+    int64_t begin, end;
+    parallelBlock(run->V, thread, threads, &begin, &end);
+    int roots = 0;
+    for (int64_t v = begin; v < end; ++v) {
+        int root = ufFind(&run->uf, (int)v);
+        __atomic_store_n(&run->uf.parent[v], root, __ATOMIC_RELAXED);
+        roots += root == v;
+    }
+    run->roots[thread] = roots;
+}
+
+// Phase 4: number the roots in vertex order, then give every vertex the id of its root.
+// A root is the smallest vertex of its set, so it always comes before the rest of the set.
+GRAPH_API void numberRoots(void *context, int thread, int threads) {
+    ComponentsRun *run = (ComponentsRun *)context;
+    int64_t begin, end;
+    parallelBlock(run->V, thread, threads, &begin, &end);
+    int next = run->roots[thread];
+    for (int64_t v = begin; v < end; ++v) {
+        if (run->uf.parent[v] == v) {
+            run->result->id[v] = next++;
+        }
+    }
+}
+
+GRAPH_API void labelVertices(void *context, int thread, int threads) {
+    ComponentsRun *run = (ComponentsRun *)context;
+    Components *result = run->result;
+    int64_t begin, end;
+    parallelBlock(run->V, thread, threads, &begin, &end);
+    for (int64_t v = begin; v < end; ++v) {
+        int root = run->uf.parent[v];
+        if (root != v) {
+            result->id[v] = result->id[root];
+        }
+        __atomic_fetch_add(&result->size[result->id[v]], 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Phase 5: count the vertices alone in their component without even a self-loop
+GRAPH_API void countIsolated(void *context, int thread, int threads) {
+    ComponentsRun *run = (ComponentsRun *)context;
+    const Graph *graph = run->graph;
+    int64_t begin, end;
+    parallelBlock(run->V, thread, threads, &begin, &end);
+    int isolated = 0;
+    for (int64_t v = begin; v < end; ++v) {
+        bool alone = graph != NULL ? graph->offsets[v + 1] == graph->offsets[v] : !run->hasEdge[v];
+        isolated += run->result->size[run->result->id[v]] == 1 && alone;
+    }
+    run->roots[thread] = isolated;
+}
+
+// Function to turn the sets of run->uf into the numbered components of run->result
+GRAPH_API void labelComponents(ComponentsRun *run, int threads) {
+    Components *result = run->result;
+    run->roots = (int *)xmalloc(threads * sizeof(int));
+    result->V = run->V;
+    result->id = (int *)xmalloc((run->V > 0 ? run->V : 1) * sizeof(int));
+    parallelRun(threads, countRoots, run);
+    result->count = 0;
+    for (int t = 0; t < threads; ++t) {
+        int roots = run->roots[t];
+        run->roots[t] = result->count;
+        result->count += roots;
+    }
+    result->size = (int *)xmalloc((result->count > 0 ? result->count : 1) * sizeof(int));
+    memset(result->size, 0, (result->count > 0 ? result->count : 1) * sizeof(int));
+    parallelRun(threads, numberRoots, run);
+    parallelRun(threads, labelVertices, run);
+    parallelRun(threads, countIsolated, run);
+    result->isolated = 0;
+    for (int t = 0; t < threads; ++t) {
+        result->isolated += run->roots[t];
+    }
+    free(run->roots);
+}
+
+// Function to find the components of a dense graph with bitset frontiers, on one thread
+GRAPH_API void denseComponents(const Graph *graph, Components *result) {
+    BitMatrix matrix;
+    initBitMatrix(&matrix, graph, true);
+    result->V = graph->V;
+    result->id = (int *)xmalloc((graph->V > 0 ? graph->V : 1) * sizeof(int));
+    result->count = bitComponents(&matrix, result->id);
+    freeBitMatrix(&matrix);
+
+    result->size = (int *)xmalloc((result->count > 0 ? result->count : 1) * sizeof(int));
+    memset(result->size, 0, (result->count > 0 ? result->count : 1) * sizeof(int));
+    for (int v = 0; v < graph->V; ++v) {
+        result->size[result->id[v]]++;
+    }
+    result->isolated = 0;
+    for (int v = 0; v < graph->V; ++v) {
+        result->isolated += result->size[result->id[v]] == 1 && graph->offsets[v + 1] == graph->offsets[v];
+    }
+}
+
+// Function to find the connected components of a graph with the given number of threads;
+// symmetric must only be true when every edge has its reverse
+GRAPH_API void connectedComponents(const Graph *graph, int threads, bool symmetric, Components *result) {
+    if (useBitMatrix(graph)) {
+        denseComponents(graph, result);
+        return;
+    }
+    ComponentsRun run;
+    run.V = graph->V;
+    run.graph = graph;
+    run.hasEdge = NULL;
+    run.result = result;
+    initUnionFind(&run.uf, graph->V);
+
+    parallelRun(threads, linkNeighbours, &run);
+    run.skip = graph->V > 0 && symmetric ? sampleBigRoot(&run) : -1;
+    parallelRun(threads, linkRemaining, &run);
+
+    labelComponents(&run, threads);
+    freeUnionFind(&run.uf);
+}
+
+// Function to find the components with one BFS per component, in order of smallest vertex.
+// bfs is initialized here; it ends up with the edges examined by the whole run and the levels
+// of the largest component's search.
+GRAPH_API void bfsComponents(const Graph *graph, bool symmetric, Components *result, BfsSearch *bfs) {
+    const Graph *undirected = symmetric ? graph : undirectedGraph(graph);
+    initBfs(bfs, undirected);
+    result->V = graph->V;
+    result->id = (int *)xmalloc((graph->V > 0 ? graph->V : 1) * sizeof(int));
+    result->size = (int *)xmalloc((graph->V > 0 ? graph->V : 1) * sizeof(int));
+    result->count = 0;
+    BfsLevel *largest = (BfsLevel *)xmalloc(sizeof(BfsLevel));
+    int largestDepth = 0;
+    int largestSize = 0;
+    for (int s = 0; s < graph->V; ++s) {
+        if (bfs->hops[s] >= 0) {
+            continue;
+        }
+        int first = bfs->reached;
+        int size = bfsFrom(undirected, undirected, s, bfs);
+        for (int i = first; i < bfs->reached; ++i) {
+            result->id[bfs->order[i]] = result->count;
+        }
+        result->size[result->count++] = size;
+        if (size > largestSize) {
+            largestSize = size;
+            largestDepth = bfs->depth;
+            largest = (BfsLevel *)xrealloc(largest, bfs->depth * sizeof(BfsLevel));
+            memcpy(largest, bfs->levels, bfs->depth * sizeof(BfsLevel));
+        }
+    }
+    free(bfs->levels);
+    bfs->levels = largest;
+    bfs->depth = largestDepth;
+    bfs->capacity = largestDepth > 0 ? largestDepth : 1;
+
+    result->isolated = 0;
+    for (int v = 0; v < graph->V; ++v) {
+        result->isolated += result->size[result->id[v]] == 1 && graph->offsets[v + 1] == graph->offsets[v];
+    }
+    if (undirected != graph) {
+        freeGraph((Graph *)undirected);
+    }
+}
+
+GRAPH_API void freeComponents(Components *components) {
+    free(components->id);
+    free(components->size);
+}
+
+#endif // COMPONENTS_H
@@ -2,7 +2,7 @@
  * @file flooding.c
  * @author Jorge Ricarte (jorgericartepg@gmail.com)
  * @brief A program to see if the graphs have connected components.
- * @version 0.1
+ * @version 0.3
  * @date 2023-10-16
  * 
  * @copyright Copyright (c) 2023
@@ -13,169 +13,179 @@
 #include <stdbool.h>
 #include <string.h>
 
-// Define structures for the graph representation
-typedef struct AdjListNode {
-    int dest;
-    struct AdjListNode* next;
-} AdjListNode;
-
-typedef struct AdjList {
-    AdjListNode* head;
-} AdjList;
-
-typedef struct Graph {
-    int V;
-    char* labels;
-    bool* visited; // Novo campo para controle de flooding
-    AdjList* array;
-} Graph;
-
-// Function to create a new adjacency list node
-AdjListNode* newAdjListNode(int dest) {
-    AdjListNode* newNode = (AdjListNode*)malloc(sizeof(AdjListNode));
-    newNode->dest = dest;
-    newNode->next = NULL;
-    return newNode;
+#include "../Common/loader.h"
+#include "components.h"
+#include "stream.h"
+
+// Função para contar o número de componentes conexas (vértices sem arestas não contam)
+int countConnectedComponents(Graph* graph, int threads) {
+    Components components;
+    connectedComponents(graph, threads, false, &components);
+    int count = components.count - components.isolated;
+    freeComponents(&components);
+    return count;
 }
 
-// Function to add an edge to the graph
-void addEdge(Graph* graph, int src, int dest) {
-    AdjListNode* newNode = newAdjListNode(dest);
-    newNode->next = graph->array[src].head;
-    graph->array[src].head = newNode;
+// Função para contar as componentes com uma BFS por componente, guardando o relatório da busca.
+// Verificar a simetria custa menos que montar a cópia não direcionada quando ela não é precisa.
+int countComponentsBfs(Graph* graph, BfsSearch* bfs) {
+    Components components;
+    bfsComponents(graph, isSymmetric(graph), &components, bfs);
+    int count = components.count - components.isolated;
+    freeComponents(&components);
+    return count;
 }
 
-// Function to create a graph from a file
-Graph* createGraph(char* fileName) {
-    // Open the input file
-    FILE* file = fopen(fileName, "r");
-    if (file == NULL) {
-        printf("Erro ao abrir o arquivo.\n");
-        exit(1);
-    }
-
-    // Read the first line to determine the number of vertices
-    char line[100];
-    fgets(line, sizeof(line), file);
-
-    int V = 0;
-    for (int i = 0; line[i] != '\0'; ++i) {
-        if (line[i] != ' ' && line[i] != '\n') {
-            ++V;
-        }
-    }
-
-    char vertexLabels[V];
-    for (int i = 0, j = 0; line[i] != '\0'; ++i) {
-        if (line[i] != ' ' && line[i] != '\n') {
-            vertexLabels[j] = line[i];
-            ++j;
-        }
-    }
-
-    // Allocate memory for the graph structure
-    Graph* graph = (Graph*)malloc(sizeof(Graph));
-    graph->V = V;
-    graph->labels = (char*)malloc(V * sizeof(char));
-    graph->visited = (bool*)malloc(V * sizeof(bool)); // Novo campo para controle de flooding
-    // ... Initializing adjacency lists and visited array ...
-    for (int i = 0; i < V; ++i) {
-        graph->labels[i] = vertexLabels[i];
-        graph->visited[i] = false; // Inicializa todos os vértices como não visitados
-    }
-
-    graph->array = (AdjList*)malloc(V * sizeof(AdjList));
-    for (int i = 0; i < V; ++i) {
-        graph->array[i].head = NULL;
-    }
+// Função para imprimir as arestas examinadas e os níveis da BFS da maior componente
+void printBfsReport(const char* name, BfsSearch* bfs) {
+    printf("\nBFS over %s: %lld edges examined (the graph has %lld)\n", name, (long long)bfs->edges, (long long)bfs->total);
+    printf("Levels of the largest component:\n");
+    printBfsLevels(bfs);
+}
 
-    // Populate the adjacency matrix from the file
-    for (int i = 0; i < V; ++i) {
-        for (int j = 0; j < V; ++j) {
-            int weight;
-            fscanf(file, "%d", &weight);
-            if (weight == 1) {
-                addEdge(graph, i, j);
-            }
-        }
+// Função para medir o tempo com 1, 2, 4, ... threads, conferindo cada resultado com o de 1 thread.
+// A simetria é verificada uma vez, fora da medição, para que o grafo não direcionado pule arestas.
+void benchmark(Graph* graph, int maxThreads) {
+    bool symmetric = isSymmetric(graph);
+    printf("%s graph, %d vertices, %lld edges\n", symmetric ? "Symmetric" : "Directed", graph->V, (long long)graph->E);
+    Components reference;
+    double start = nowSeconds();
+    connectedComponents(graph, 1, symmetric, &reference);
+    double base = nowSeconds() - start;
+    printf("threads\tseconds\tspeedup\tcomponents\tmatches\n");
+    printf("1\t%.3f\t1.00\t%d\tyes\n", base, reference.count);
+    for (int threads = 2; threads / 2 < maxThreads; threads *= 2) {
+        threads = threads < maxThreads ? threads : maxThreads;
+        Components components;
+        start = nowSeconds();
+        connectedComponents(graph, threads, symmetric, &components);
+        double elapsed = nowSeconds() - start;
+        bool matches = components.count == reference.count && memcmp(components.id, reference.id, graph->V * sizeof(int)) == 0;
+        printf("%d\t%.3f\t%.2f\t%d\t%s\n", threads, elapsed, base / elapsed, components.count, matches ? "yes" : "NO");
+        freeComponents(&components);
     }
+    freeComponents(&reference);
+}
 
-    fclose(file);
+// Função para contar as componentes lendo o arquivo em fluxo, sem montar o grafo
+int streamConnectedComponents(char* file, int threads, LabelTable* labels, int* V) {
+    Components components;
+    streamComponents(file, threads, &components, labels);
+    int count = components.count - components.isolated;
+    *V = components.V;
+    freeComponents(&components);
+    return count;
+}
 
-    return graph;
+// Função para imprimir os rótulos de um grafo lido em fluxo, como printLabels
+void printStreamLabels(LabelTable* labels, int V) {
+    printLabelLine(labels->count > 0 ? labels : NULL, V);
 }
 
-// Função para marcar vértices visitados usando flooding
-void flood(Graph* graph, int v, bool visited[]) {
-    visited[v] = true;
-    AdjListNode* current = graph->array[v].head;
-    while (current != NULL) {
-        int dest = current->dest;
-        if (!visited[dest]) {
-            flood(graph, dest, visited);
+int main(int argc, char* argv[]) {
+    // Leia os dois arquivos de grafo e as opções
+    char* file1 = NULL;
+    char* file2 = NULL;
+    int threads = defaultThreadCount();
+    bool bench = false;
+    bool stream = false;
+    bool bfsEngine = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = atoi(argv[i] + 10);
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench = true;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream = true;
+        } else if (strcmp(argv[i], "--engine=bfs") == 0) {
+            bfsEngine = true;
+        } else if (strcmp(argv[i], "--engine=unionfind") == 0) {
+            bfsEngine = false;
+        } else if (statsOption(argv[i], argv[0])) {
+            continue;
+        } else if (file1 == NULL) {
+            file1 = argv[i];
+        } else if (file2 == NULL) {
+            file2 = argv[i];
+        } else {
+            file1 = NULL;
+            break;
         }
-        current = current->next;
     }
-}
-
-// Função para contar o número de componentes conexas
-int countConnectedComponents(Graph* graph) {
-    int components = 0;
-    bool* visited = (bool*)malloc(graph->V * sizeof(bool)); // Array temporário para rastrear visitas
-
-    for (int i = 0; i < graph->V; ++i) {
-        visited[i] = false;
+    if (file1 == NULL || threads < 1 || (file2 == NULL) != bench || (bench && stream) || (bfsEngine && (stream || bench))) {
+        printf("Usage: %s <file1> <file2> [--engine=unionfind|bfs] [--threads=N] [--stream] [--stats[=FILE]]\n", argv[0]);
+        printf("       %s <file> --bench [--threads=N]\n", argv[0]);
+        return 1;
     }
 
-    for (int i = 0; i < graph->V; ++i) {
-        if (!visited[i] && graph->array[i].head != NULL) {
-            components++;
-            flood(graph, i, visited);
-        }
+    if (bench) {
+        Graph* graph = createGraph(file1);
+        statPhase(PHASE_COMPUTE);
+        benchmark(graph, threads);
+        freeGraph(graph);
+        return 0;
     }
 
-    free(visited); // Liberar a memória alocada para o array temporário
-    return components;
-}
+    // No modo em fluxo as arestas vão direto do leitor para o union-find, com memória O(V)
+    if (stream) {
+        LabelTable labels1;
+        LabelTable labels2;
+        int V1, V2;
+        int components1 = streamConnectedComponents(file1, threads, &labels1, &V1);
+        int components2 = streamConnectedComponents(file2, threads, &labels2, &V2);
 
+        statPhase(PHASE_OUTPUT);
+        printf("Graph 1:\n");
+        printStreamLabels(&labels1, V1);
 
+        printf("\nGraph 2:\n");
+        printStreamLabels(&labels2, V2);
 
-int main(int argc, char* argv[]) {
-    // Verifique se há dois argumentos de linha de comando (dois arquivos de grafo)
-    if (argc != 3) {
-        printf("Usage: %s <file1> <file2>\n", argv[0]);
-        return 1;
-    }
+        printf("\nNumber of connected components in Graph 1: %d\n", components1);
+        printf("Number of connected components in Graph 2: %d\n", components2);
 
-    char* file1 = argv[1];
-    char* file2 = argv[2];
+        freeLabels(&labels1);
+        freeLabels(&labels2);
+        return 0;
+    }
 
     // Crie os grafos
     Graph* graph1 = createGraph(file1);
     Graph* graph2 = createGraph(file2);
 
+    statPhase(PHASE_OUTPUT);
     printf("Graph 1:\n");
-    printf("Vertex labels: %s\n", graph1->labels);
+    printLabels(graph1);
 
     printf("\nGraph 2:\n");
-    printf("Vertex labels: %s\n", graph2->labels);
-
-    int components1 = countConnectedComponents(graph1);
-    int components2 = countConnectedComponents(graph2);
-
-    printf("\nNumber of connected components in Graph 1: %d\n", components1);
-    printf("Number of connected components in Graph 2: %d\n", components2);
-
-    // Libere a memória alocada para os grafos, etiquetas e array visited
-    free(graph1->labels);
-    free(graph1->visited);
-    free(graph1->array);
-    free(graph1);
+    printLabels(graph2);
+
+    if (bfsEngine) {
+        BfsSearch bfs1, bfs2;
+        statPhase(PHASE_COMPUTE);
+        int components1 = countComponentsBfs(graph1, &bfs1);
+        int components2 = countComponentsBfs(graph2, &bfs2);
+        statPhase(PHASE_OUTPUT);
+
+        printf("\nNumber of connected components in Graph 1: %d\n", components1);
+        printf("Number of connected components in Graph 2: %d\n", components2);
+        printBfsReport("Graph 1", &bfs1);
+        printBfsReport("Graph 2", &bfs2);
+        freeBfs(&bfs1);
+        freeBfs(&bfs2);
+    } else {
+        statPhase(PHASE_COMPUTE);
+        int components1 = countConnectedComponents(graph1, threads);
+        int components2 = countConnectedComponents(graph2, threads);
+        statPhase(PHASE_OUTPUT);
+
+        printf("\nNumber of connected components in Graph 1: %d\n", components1);
+        printf("Number of connected components in Graph 2: %d\n", components2);
+    }
 
-    free(graph2->labels);
-    free(graph2->visited);
-    free(graph2->array);
-    free(graph2);
+    // Libere a memória alocada para os grafos
+    freeGraph(graph1);
+    freeGraph(graph2);
 
     return 0;
 }
@@ -0,0 +1,76 @@
+/**
+ * @file stream.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Connected components of a file in one pass, without building the graph.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Every edge goes from the parser straight into a union-find and is then forgotten. The
+ * union-find and the seen-vertex flags double as larger ids show up, so memory is O(V)
+ * whatever the edge count; the file itself is read through a streaming scanner that never
+ * keeps more than 64 MB of it. The components are numbered exactly like connectedComponents
+ * numbers them.
+ */
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "../Common/loader.h"
+#include "components.h"
+
+typedef struct ComponentStream {
+    UnionFind uf;
+    bool *hasEdge;
+    int capacity;
+    int64_t edges;
+} ComponentStream;
+
+// Function to make room for vertex ids up to v
+GRAPH_API void reserveVertices(ComponentStream *stream, int v) {
+    if (v < stream->capacity) {
+        return;
+    }
+    int capacity = v < INT32_MAX / 2 ? 2 * v + 1 : INT32_MAX;
+    growUnionFind(&stream->uf, capacity);
+    stream->hasEdge = (bool *)xrealloc(stream->hasEdge, capacity * sizeof(bool));
+    memset(stream->hasEdge + stream->capacity, 0, (capacity - stream->capacity) * sizeof(bool));
+    stream->capacity = capacity;
+}
+
+GRAPH_API void streamEdge(void *context, int src, int dest, int weight) {
+    (void)weight;
+    ComponentStream *stream = (ComponentStream *)context;
+    reserveVertices(stream, src > dest ? src : dest);
+    stream->hasEdge[src] = stream->hasEdge[dest] = true;
+    ufUnion(&stream->uf, src, dest);
+    stream->edges++;
+}
+
+// Function to find the connected components of the graph in a file while it is read;
+// returns the number of edges read and stores the vertex names in *labels (see streamEdges)
+GRAPH_API int64_t streamComponents(const char *fileName, int threads, Components *result, LabelTable *labels) {
+    ComponentStream stream;
+    initUnionFind(&stream.uf, 0);
+    stream.hasEdge = NULL;
+    stream.capacity = 0;
+    stream.edges = 0;
+    EdgeSink sink = {streamEdge, &stream};
+    int V = streamEdges(fileName, &sink, labels);
+    statAdd(STAT_EDGES_READ, stream.edges);
+    statPhase(PHASE_COMPUTE);
+    reserveVertices(&stream, V); // Formats that announce V can have vertices with no edge at all
+
+    ComponentsRun run;
+    run.V = V;
+    run.graph = NULL;
+    run.hasEdge = stream.hasEdge;
+    run.uf = stream.uf;
+    run.result = result;
+    labelComponents(&run, threads);
+    freeUnionFind(&stream.uf);
+    free(stream.hasEdge);
+    return stream.edges;
+}
+
+#endif // STREAM_H
@@ -0,0 +1,256 @@
+/**
+ * @file graphs.c
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief One driver for the adjacency, components, shortest path and spanning forest tools.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * "graphs run <file> <analysis> ..." reads the file once and runs every analysis on the same
+ * graph. The graph is never written after loading, so the analyses run side by side on a
+ * small pool of threads, each with its own workspace; their reports are printed afterwards
+ * in the order they were asked for, so the output does not depend on the scheduling. The
+ * single-analysis subcommands (graphs components <file>, ...) are the same pipeline with one
+ * step.
+ */
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../Common/loader.h"
+#include "../Common/parallel.h"
+#include "../Dijkstra/sssp.h"
+#include "../Flooding/components.h"
+#include "../Prim/mst.h"
+
+#define MAX_ANALYSES 64
+
+typedef enum AnalysisKind {
+    ANALYSIS_ADJACENCY,
+    ANALYSIS_COMPONENTS,
+    ANALYSIS_SSSP,
+    ANALYSIS_MST
+} AnalysisKind;
+
+typedef struct Analysis {
+    AnalysisKind kind;
+    const char *spec;          // As written on the command line
+    const char *vertexName;    // The part after the colon, a vertex name or number, or NULL
+    int vertex;                // Source of sssp, start of mst, once the graph is loaded
+    int components;
+    SsspWorkspace ws;
+    SpanningForest forest;
+} Analysis;
+
+typedef struct Pipeline {
+    const Graph *graph;
+    const Graph *undirected;   // The graph itself when it is symmetric, built once otherwise
+    bool symmetric;
+    Analysis *analyses;
+    int count;
+    int innerThreads;          // Threads for each analysis that can use more than one
+    atomic_int next;           // Next analysis to hand out
+} Pipeline;
+
+void printUsage(const char *program) {
+    printf("Usage: %s run <file> <analysis> [<analysis> ...] [--threads=N] [--stats[=FILE]]\n", program);
+    printf("       %s run <file> <analysis> --output=csv|binary\n", program);
+    printf("       %s adjacency|components <file> [--threads=N] [--stats[=FILE]]\n", program);
+    printf("       %s sssp <file> <source> | %s mst <file> [start] [...]\n", program, program);
+    printf("Analyses: adjacency, components, sssp:<source>, mst or mst:<start>; a vertex is a name or a number.\n");
+    exit(1);
+}
+
+// Function to read an analysis such as "sssp:3"; false if the name is unknown or the vertex is
+// missing or not wanted
+bool parseAnalysis(const char *spec, Analysis *analysis) {
+    const char *colon = strchr(spec, ':');
+    size_t length = colon != NULL ? (size_t)(colon - spec) : strlen(spec);
+    analysis->spec = spec;
+    analysis->vertexName = colon != NULL ? colon + 1 : NULL;
+    analysis->vertex = 0;
+    if (length == 9 && strncmp(spec, "adjacency", 9) == 0) {
+        analysis->kind = ANALYSIS_ADJACENCY;
+    } else if (length == 10 && strncmp(spec, "components", 10) == 0) {
+        analysis->kind = ANALYSIS_COMPONENTS;
+    } else if (length == 4 && strncmp(spec, "sssp", 4) == 0) {
+        analysis->kind = ANALYSIS_SSSP;
+    } else if (length == 3 && strncmp(spec, "mst", 3) == 0) {
+        analysis->kind = ANALYSIS_MST;
+    } else {
+        return false;
+    }
+    if (colon == NULL) {
+        return analysis->kind != ANALYSIS_SSSP;
+    }
+    return (analysis->kind == ANALYSIS_SSSP || analysis->kind == ANALYSIS_MST) && colon[1] != '\0';
+}
+
+// Function to run one analysis on the shared graph, keeping its result for printing
+void computeAnalysis(Pipeline *pipeline, Analysis *analysis) {
+    const Graph *graph = pipeline->graph;
+    switch (analysis->kind) {
+    case ANALYSIS_ADJACENCY:
+        break; // Nothing to compute: the report is the graph itself
+    case ANALYSIS_COMPONENTS: {
+        Components components;
+        connectedComponents(graph, pipeline->innerThreads, pipeline->symmetric, &components);
+        analysis->components = components.count - components.isolated;
+        freeComponents(&components);
+        break;
+    }
+    case ANALYSIS_SSSP:
+        initWorkspace(&analysis->ws, graph->V);
+        dijkstra(graph, analysis->vertex, SSSP_AUTO, &analysis->ws);
+        break;
+    case ANALYSIS_MST:
+        primForest(pipeline->undirected, analysis->vertex, &analysis->forest);
+        break;
+    }
+}
+
+// Function to print the report of an analysis and release its result
+void printAnalysis(const Pipeline *pipeline, Analysis *analysis) {
+    const Graph *graph = pipeline->graph;
+    switch (analysis->kind) {
+    case ANALYSIS_ADJACENCY:
+        printAdjacency(graph, false);
+        break;
+    case ANALYSIS_COMPONENTS:
+        if (outputFormat() == OUTPUT_TEXT) {
+            printf("Number of connected components: %d\n", analysis->components);
+        } else if (outputFormat() == OUTPUT_CSV) {
+            printf("components\n%d\n", analysis->components);
+        } else {
+            outputBytes(&analysis->components, sizeof(int));
+            outputFlush();
+        }
+        break;
+    case ANALYSIS_SSSP:
+        printDistances(graph, analysis->vertex, &analysis->ws);
+        freeWorkspace(&analysis->ws);
+        break;
+    case ANALYSIS_MST:
+        printForest(graph, &analysis->forest, "Prim's");
+        freeForest(&analysis->forest);
+        break;
+    }
+}
+
+// Worker of the pool: takes analyses in order until none is left
+void pipelineWorker(void *context, int thread, int threads) {
+    (void)thread;
+    (void)threads;
+    Pipeline *pipeline = (Pipeline *)context;
+    int i;
+    while ((i = atomic_fetch_add(&pipeline->next, 1)) < pipeline->count) {
+        computeAnalysis(pipeline, &pipeline->analyses[i]);
+    }
+}
+
+// Function to load the file once, check every analysis against it, run them and print the reports
+int runPipeline(const char *file, Analysis *analyses, int count, int threads) {
+    Graph *graph = createGraph(file);
+    bool needsUndirected = false;
+    for (int i = 0; i < count; ++i) {
+        Analysis *analysis = &analyses[i];
+        if (analysis->vertexName != NULL && graph->V > 0) {
+            analysis->vertex = findVertex(graph, analysis->vertexName);
+            if (analysis->vertex < 0) {
+                printf("%s: vertex must be %sbetween 0 and %d.\n", analysis->spec,
+                       graph->labels != NULL ? "a vertex name or " : "", graph->V - 1);
+                exit(1);
+            }
+        }
+        if (analysis->kind == ANALYSIS_SSSP && (graph->V == 0 || hasNegativeWeight(graph))) {
+            printf("%s: %s\n", analysis->spec, graph->V == 0 ? "the graph has no vertices." :
+                   "Dijkstra's algorithm needs non-negative edge weights.");
+            exit(1);
+        }
+        needsUndirected |= analysis->kind == ANALYSIS_MST;
+    }
+
+    // The derived graphs are built here, before the workers start, and only read afterwards
+    Pipeline pipeline;
+    pipeline.graph = graph;
+    pipeline.symmetric = isSymmetric(graph);
+    pipeline.undirected = needsUndirected && !pipeline.symmetric ? undirectedGraph(graph) : graph;
+    pipeline.analyses = analyses;
+    pipeline.count = count;
+    int workers = threads < count ? threads : count;
+    pipeline.innerThreads = threads / workers > 1 ? threads / workers : 1;
+    atomic_init(&pipeline.next, 0);
+
+    statPhase(PHASE_COMPUTE);
+    parallelRun(workers, pipelineWorker, &pipeline);
+
+    statPhase(PHASE_OUTPUT);
+    for (int i = 0; i < count; ++i) {
+        if (count > 1) {
+            printf("%s== %s ==\n", i > 0 ? "\n" : "", analyses[i].spec);
+        }
+        printAnalysis(&pipeline, &analyses[i]);
+    }
+
+    if (pipeline.undirected != graph) {
+        freeGraph((Graph *)pipeline.undirected);
+    }
+    freeGraph(graph);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+    }
+    const char *command = argv[1];
+    const char *file = NULL;
+    const char *vertex = NULL;
+    int threads = defaultThreadCount();
+    Analysis analyses[MAX_ANALYSES];
+    int count = 0;
+    bool pipeline = strcmp(command, "run") == 0;
+
+    for (int i = 2; i < argc; ++i) {
+        if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = atoi(argv[i] + 10);
+        } else if (outputOption(argv[i]) || statsOption(argv[i], argv[0])) {
+            continue;
+        } else if (file == NULL) {
+            file = argv[i];
+        } else if (!pipeline && vertex == NULL) {
+            vertex = argv[i];
+        } else if (pipeline && count < MAX_ANALYSES) {
+            if (!parseAnalysis(argv[i], &analyses[count++])) {
+                printf("Unknown analysis %s.\n", argv[i]);
+                printUsage(argv[0]);
+            }
+        } else {
+            printUsage(argv[0]);
+        }
+    }
+
+    // A subcommand is a pipeline of one analysis; its vertex argument stands for the ":N" suffix
+    if (!pipeline) {
+        char *spec = (char *)xmalloc(strlen(command) + (vertex != NULL ? strlen(vertex) : 0) + 2);
+        sprintf(spec, "%s%s%s", command, vertex != NULL ? ":" : "", vertex != NULL ? vertex : "");
+        bool known = parseAnalysis(spec, &analyses[0]);
+        free(spec);
+        if (!known) {
+            printUsage(argv[0]);
+        }
+        analyses[0].spec = command;
+        analyses[0].vertexName = vertex;
+        count = 1;
+    }
+    if (file == NULL || count == 0 || threads < 1) {
+        printUsage(argv[0]);
+    }
+    if (count > 1 && outputFormat() != OUTPUT_TEXT) {
+        printf("CSV and binary output take a single analysis.\n");
+        exit(1);
+    }
+    return runPipeline(file, analyses, count, threads);
+}
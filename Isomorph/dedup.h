@@ -0,0 +1,162 @@
+/**
+ * @file dedup.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Bulk isomorphism dedup: bucket graphs by WL hash, then match exactly inside buckets.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Isomorphic graphs always get the same wlHash, so graphs in different buckets are told
+ * apart without any search. Inside a bucket each graph is matched against one
+ * representative per class found so far, and opens a new class when none matches.
+ */
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include "../Common/loader.h"
+#include "iso.h"
+
+typedef struct HashedGraph {
+    uint64_t hash;
+    int index;
+} HashedGraph;
+
+GRAPH_API int compareHashed(const void *a, const void *b) {
+    const HashedGraph *x = (const HashedGraph *)a;
+    const HashedGraph *y = (const HashedGraph *)b;
+    if (x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+    return x->index - y->index;
+}
+
+// Function to read one file name per line, skipping blank lines
+GRAPH_API char **readFileList(const char *listFile, int *count) {
+    FILE *file = fopen(listFile, "r");
+    if (file == NULL) {
+        printf("Error opening the file.\n");
+        exit(1);
+    }
+    int capacity = 64;
+    char **names = (char **)xmalloc(capacity * sizeof(char *));
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    *count = 0;
+    while ((length = getline(&line, &size, file)) != -1) {
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        if (length == 0) {
+            continue;
+        }
+        if (*count == capacity) {
+            capacity *= 2;
+            names = (char **)xrealloc(names, capacity * sizeof(char *));
+        }
+        names[(*count)++] = strdup(line);
+    }
+    free(line);
+    fclose(file);
+    return names;
+}
+
+// Function to group the graphs in the given files into isomorphism classes and print them
+GRAPH_API void dedupGraphs(char **files, int count) {
+    Graph **graphs = (Graph **)xmalloc((count > 0 ? count : 1) * sizeof(Graph *));
+    HashedGraph *keys = (HashedGraph *)xmalloc((count > 0 ? count : 1) * sizeof(HashedGraph));
+    int maxV = 1;
+    double start = nowSeconds();
+    for (int i = 0; i < count; ++i) {
+        graphs[i] = createGraph(files[i]);
+        statPhase(PHASE_COMPUTE);
+        keys[i].hash = wlHash(graphs[i]);
+        keys[i].index = i;
+        maxV = graphs[i]->V > maxV ? graphs[i]->V : maxV;
+    }
+    double hashed = nowSeconds();
+    qsort(keys, count, sizeof(HashedGraph), compareHashed);
+
+    int *classOf = (int *)xmalloc((count > 0 ? count : 1) * sizeof(int));
+    int *representative = (int *)xmalloc((count > 0 ? count : 1) * sizeof(int));
+    int *mapping = (int *)xmalloc(maxV * sizeof(int));
+    int classes = 0;
+    int buckets = 0;
+    int64_t checks = 0;
+    for (int b = 0; b < count;) {
+        int e = b;
+        while (e < count && keys[e].hash == keys[b].hash) {
+            e++;
+        }
+        buckets++;
+        int firstClass = classes;
+        for (int k = b; k < e; ++k) {
+            int g = keys[k].index;
+            classOf[g] = -1;
+            for (int c = firstClass; c < classes && classOf[g] < 0; ++c) {
+                checks++;
+                if (findIsomorphism(graphs[representative[c]], graphs[g], mapping, NULL)) {
+                    classOf[g] = c;
+                }
+            }
+            if (classOf[g] < 0) {
+                representative[classes] = g;
+                classOf[g] = classes++;
+            }
+        }
+        b = e;
+    }
+    double matched = nowSeconds();
+    statPhase(PHASE_OUTPUT);
+
+    // Number the classes by their first member in input order, then list members in input order
+    int *number = (int *)xmalloc((classes > 0 ? classes : 1) * sizeof(int));
+    int *first = (int *)xmalloc((classes + 1) * sizeof(int));
+    int *members = (int *)xmalloc((count > 0 ? count : 1) * sizeof(int));
+    int numbered = 0;
+    for (int c = 0; c < classes; ++c) {
+        number[c] = -1;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (number[classOf[i]] < 0) {
+            number[classOf[i]] = numbered++;
+        }
+    }
+    for (int c = 0; c <= classes; ++c) {
+        first[c] = 0;
+    }
+    for (int i = 0; i < count; ++i) {
+        first[number[classOf[i]] + 1]++;
+    }
+    for (int c = 0; c < classes; ++c) {
+        first[c + 1] += first[c];
+    }
+    for (int i = 0; i < count; ++i) {
+        members[first[number[classOf[i]]]++] = i;
+    }
+    for (int c = 0, at = 0; c < classes; ++c) {
+        int size = first[c] - at;
+        printf("Class %d (%d graph%s):", c + 1, size, size == 1 ? "" : "s");
+        for (; at < first[c]; ++at) {
+            printf(" %s", files[members[at]]);
+        }
+        printf("\n");
+    }
+    printf("%d graphs, %d hash buckets, %lld exact checks, %d classes\n", count, buckets, (long long)checks, classes);
+    printf("Loading and hashing: %.3f s, matching: %.3f s\n", hashed - start, matched - hashed);
+
+    for (int i = 0; i < count; ++i) {
+        freeGraph(graphs[i]);
+    }
+    free(members);
+    free(first);
+    free(number);
+    free(mapping);
+    free(representative);
+    free(classOf);
+    free(keys);
+    free(graphs);
+}
+
+#endif // DEDUP_H
@@ -0,0 +1,618 @@
+/**
+ * @file iso.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Graph isomorphism: invariant pruning, color refinement and a VF2++-style matcher.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Before any search the vertex counts, edge counts and degree sequences must agree. Then
+ * both graphs go through color refinement (1-WL): a vertex color starts as its degrees and
+ * is repeatedly hashed together with the sorted colors of its neighbours until the number
+ * of classes stops growing. Colors are isomorphism invariants, so the color histograms
+ * must agree too, and a vertex can only map to a vertex of its own color.
+ *
+ * The search follows VF2++: vertices of graph 1 are put in a BFS order that starts from the
+ * rarest color and, inside a level, prefers vertices with more already-ordered neighbours,
+ * then higher degree, then rarer color. Each vertex is matched against the neighbours of an
+ * already-matched neighbour's image, and a pair is kept only when every edge to the matched
+ * part is preserved in both directions, so a full depth is an isomorphism. As a lookahead,
+ * the unmatched neighbours of both vertices must also split the same way into ones that
+ * touch the matched part and ones that do not, with the same colors and touch counts; this
+ * prunes most dead branches early on regular graphs, where colors cannot tell vertices apart.
+ */
+#ifndef ISO_H
+#define ISO_H
+
+#include <stdatomic.h>
+
+#include "../Common/bitset.h"
+#include "../Common/graph.h"
+#include "../Common/heap.h"
+
+typedef struct IsoMatcher {
+    int V;
+    const Graph *graph[2];
+    const Graph *reverse[2];   // In-edges; the graph itself when it is symmetric
+    uint64_t *color[2];
+    int *order;                // Vertices of graph 1 in matching order
+    int *anchor;               // Earlier vertex adjacent to each vertex of graph 1, or -1
+    bool *anchorOut;           // True when the anchor is an out-neighbour (edge u -> anchor)
+    bool dense;                // Edge tests and matched counts go through bit matrices
+    BitMatrix bits[2];         // Out-edges of each graph when dense
+    BitMatrix reverseBits[2];  // In-edges when dense and directed
+    int64_t states;            // Pairs tried by the search
+} IsoMatcher;
+
+// State of one search, so several searches can share a matcher
+typedef struct IsoState {
+    int *core[2];              // core[0][u] = image of u in graph 2, core[1][v] = preimage, -1 when unmatched
+    int *touching[2];          // Matched neighbours of each vertex, counted over out- and in-edges
+    uint64_t *matched[2];      // Matched vertices of each side as bitsets, when the matcher is dense
+} IsoState;
+
+// Function to scramble 64 bits (splitmix64 finalizer)
+GRAPH_API uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+GRAPH_API uint64_t hashCombine(uint64_t h, uint64_t x) {
+    return mix64(h ^ (x + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2)));
+}
+
+GRAPH_API int compareColors(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Function to count the distinct values of an array, sorting the scratch copy
+GRAPH_API int countClasses(const uint64_t *colors, uint64_t *scratch, int V) {
+    memcpy(scratch, colors, V * sizeof(uint64_t));
+    qsort(scratch, V, sizeof(uint64_t), compareColors);
+    int classes = V > 0;
+    for (int i = 1; i < V; ++i) {
+        classes += scratch[i] != scratch[i - 1];
+    }
+    return classes;
+}
+
+// Function to color the vertices by color refinement; equal graphs get equal colors
+GRAPH_API void refineColors(const Graph *graph, const Graph *reverse, uint64_t *colors) {
+    int V = graph->V;
+    uint64_t *next = (uint64_t *)xmalloc((V > 0 ? V : 1) * sizeof(uint64_t));
+    uint64_t *scratch = (uint64_t *)xmalloc((V > 0 ? V : 1) * sizeof(uint64_t));
+    int64_t maxDegree = 1;
+    for (int v = 0; v < V; ++v) {
+        int64_t out = graph->offsets[v + 1] - graph->offsets[v];
+        int64_t in = reverse->offsets[v + 1] - reverse->offsets[v];
+        colors[v] = hashCombine(hashCombine(mix64((uint64_t)out), (uint64_t)in), findEdge(graph, v, v) >= 0);
+        maxDegree = out > maxDegree ? out : maxDegree;
+        maxDegree = in > maxDegree ? in : maxDegree;
+    }
+    uint64_t *neighbours = (uint64_t *)xmalloc(maxDegree * sizeof(uint64_t));
+
+    int classes = countClasses(colors, scratch, V);
+    for (;;) {
+        for (int v = 0; v < V; ++v) {
+            uint64_t h = colors[v];
+            const Graph *sides[2] = {graph, reverse};
+            for (int side = 0; side < 2 && (side == 0 || reverse != graph); ++side) {
+                const Graph *g = sides[side];
+                int count = 0;
+                for (int64_t e = g->offsets[v]; e < g->offsets[v + 1]; ++e) {
+                    neighbours[count++] = colors[g->dest[e]];
+                }
+                qsort(neighbours, count, sizeof(uint64_t), compareColors);
+                h = hashCombine(h, (uint64_t)side + 0x51ull);
+                for (int i = 0; i < count; ++i) {
+                    h = hashCombine(h, neighbours[i]);
+                }
+            }
+            next[v] = h;
+        }
+        int refined = countClasses(next, scratch, V);
+        if (refined <= classes) {
+            break; // Stable: another round would only rename the classes
+        }
+        classes = refined;
+        memcpy(colors, next, V * sizeof(uint64_t));
+    }
+
+    free(neighbours);
+    free(scratch);
+    free(next);
+}
+
+// Function to hash a whole graph from V, E and its sorted stable colors; isomorphic graphs collide
+GRAPH_API uint64_t wlHash(const Graph *graph) {
+    int V = graph->V;
+    const Graph *reverse = isSymmetric(graph) ? graph : transposeGraph(graph);
+    uint64_t *colors = (uint64_t *)xmalloc((V > 0 ? V : 1) * sizeof(uint64_t));
+    refineColors(graph, reverse, colors);
+    qsort(colors, V, sizeof(uint64_t), compareColors);
+    uint64_t h = hashCombine(mix64((uint64_t)V), (uint64_t)graph->E);
+    for (int v = 0; v < V; ++v) {
+        h = hashCombine(h, colors[v]);
+    }
+    free(colors);
+    if (reverse != graph) {
+        freeGraph((Graph *)reverse);
+    }
+    return h;
+}
+
+// Function to compare two sorted copies of per-vertex values
+GRAPH_API bool sameMultiset(const uint64_t *a, const uint64_t *b, int V) {
+    uint64_t *x = (uint64_t *)xmalloc((V > 0 ? V : 1) * sizeof(uint64_t));
+    uint64_t *y = (uint64_t *)xmalloc((V > 0 ? V : 1) * sizeof(uint64_t));
+    memcpy(x, a, V * sizeof(uint64_t));
+    memcpy(y, b, V * sizeof(uint64_t));
+    qsort(x, V, sizeof(uint64_t), compareColors);
+    qsort(y, V, sizeof(uint64_t), compareColors);
+    bool same = memcmp(x, y, V * sizeof(uint64_t)) == 0;
+    free(x);
+    free(y);
+    return same;
+}
+
+// Function to count how many vertices of graph 2 share the color of each vertex of graph 1
+GRAPH_API void colorRarity(IsoMatcher *m, int *rarity) {
+    int V = m->V;
+    uint64_t *sorted = (uint64_t *)xmalloc((V > 0 ? V : 1) * sizeof(uint64_t));
+    memcpy(sorted, m->color[1], V * sizeof(uint64_t));
+    qsort(sorted, V, sizeof(uint64_t), compareColors);
+    for (int u = 0; u < V; ++u) {
+        uint64_t c = m->color[0][u];
+        int lo = 0, hi = V;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (sorted[mid] < c) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        int end = lo;
+        while (end < V && sorted[end] == c) {
+            end++;
+        }
+        rarity[u] = end - lo;
+    }
+    free(sorted);
+}
+
+typedef struct RootCandidate {
+    int rarity;
+    int vertex;
+    int64_t degree;
+} RootCandidate;
+
+GRAPH_API int compareRoots(const void *a, const void *b) {
+    const RootCandidate *x = (const RootCandidate *)a;
+    const RootCandidate *y = (const RootCandidate *)b;
+    if (x->rarity != y->rarity) {
+        return x->rarity < y->rarity ? -1 : 1;
+    }
+    if (x->degree != y->degree) {
+        return x->degree > y->degree ? -1 : 1;
+    }
+    return (x->vertex > y->vertex) - (x->vertex < y->vertex);
+}
+
+// Function to put the vertices of graph 1 in VF2++ matching order
+GRAPH_API void matchingOrder(IsoMatcher *m) {
+    int V = m->V;
+    const Graph *g = m->graph[0];
+    const Graph *r = m->reverse[0];
+    int *rarity = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    int *conn = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    bool *seen = (bool *)xmalloc((V > 0 ? V : 1) * sizeof(bool));
+    int *level = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    bool *placed = (bool *)xmalloc((V > 0 ? V : 1) * sizeof(bool));
+    colorRarity(m, rarity);
+    for (int v = 0; v < V; ++v) {
+        conn[v] = 0;
+        seen[v] = false;
+        placed[v] = false;
+        m->anchor[v] = -1;
+        m->anchorOut[v] = false;
+    }
+
+    // Within a level: most placed neighbours, then highest degree, then rarest color
+    IndexedHeap heap;
+    initHeap(&heap, V > 0 ? V : 1);
+    enableHeapTies(&heap);
+
+    // Component roots: rarest color first, then highest degree
+    RootCandidate *roots = (RootCandidate *)xmalloc((V > 0 ? V : 1) * sizeof(RootCandidate));
+    for (int v = 0; v < V; ++v) {
+        roots[v].rarity = rarity[v];
+        roots[v].degree = g->offsets[v + 1] - g->offsets[v];
+        roots[v].vertex = v;
+    }
+    qsort(roots, V, sizeof(RootCandidate), compareRoots);
+
+    int count = 0;
+    for (int candidate = 0; count < V; ++candidate) {
+        int root = roots[candidate].vertex;
+        if (seen[root]) {
+            continue;
+        }
+        seen[root] = true;
+        int levelSize = 1;
+        level[0] = root;
+
+        while (levelSize > 0) {
+            for (int i = 0; i < levelSize; ++i) {
+                int v = level[i];
+                int64_t degree = (g->offsets[v + 1] - g->offsets[v]) + (r->offsets[v + 1] - r->offsets[v]);
+                heapPushOrDecreaseTie(&heap, v, -(((int64_t)conn[v] << 32) | degree), rarity[v]);
+            }
+            while (!heapEmpty(&heap)) {
+                int u = heapPop(&heap);
+                m->order[count++] = u;
+                placed[u] = true;
+                const Graph *sides[2] = {g, r};
+                for (int side = 0; side < 2; ++side) {
+                    for (int64_t e = sides[side]->offsets[u]; e < sides[side]->offsets[u + 1]; ++e) {
+                        int w = sides[side]->dest[e];
+                        if (w == u) {
+                            continue; // A loop says nothing about the order
+                        }
+                        if (placed[w]) {
+                            if (m->anchor[u] < 0) {
+                                m->anchor[u] = w;
+                                m->anchorOut[u] = side == 0;
+                            }
+                            continue;
+                        }
+                        conn[w]++;
+                        if (inHeap(&heap, w)) {
+                            int64_t degree = (g->offsets[w + 1] - g->offsets[w]) + (r->offsets[w + 1] - r->offsets[w]);
+                            heapPushOrDecreaseTie(&heap, w, -(((int64_t)conn[w] << 32) | degree), rarity[w]);
+                        }
+                    }
+                }
+            }
+
+            // Next level: unseen neighbours of this one, in both directions
+            int nextSize = 0;
+            int *next = level + levelSize;
+            for (int i = 0; i < levelSize; ++i) {
+                const Graph *sides[2] = {g, r};
+                for (int side = 0; side < 2; ++side) {
+                    for (int64_t e = sides[side]->offsets[level[i]]; e < sides[side]->offsets[level[i] + 1]; ++e) {
+                        int w = sides[side]->dest[e];
+                        if (!seen[w]) {
+                            seen[w] = true;
+                            next[nextSize++] = w;
+                        }
+                    }
+                }
+            }
+            memmove(level, next, nextSize * sizeof(int));
+            levelSize = nextSize;
+        }
+    }
+
+    freeHeap(&heap);
+    free(roots);
+    free(placed);
+    free(level);
+    free(seen);
+    free(conn);
+    free(rarity);
+}
+
+// Function to check the invariants and prepare the search; false when the graphs cannot be isomorphic
+GRAPH_API bool prepareIso(IsoMatcher *m, const Graph *graph1, const Graph *graph2) {
+    memset(m, 0, sizeof(*m));
+    if (graph1->V != graph2->V || graph1->E != graph2->E) {
+        return false;
+    }
+    int V = graph1->V;
+    m->V = V;
+    m->graph[0] = graph1;
+    m->graph[1] = graph2;
+    for (int side = 0; side < 2; ++side) {
+        m->reverse[side] = isSymmetric(m->graph[side]) ? m->graph[side] : transposeGraph(m->graph[side]);
+    }
+
+    // Degree sequences, then color histograms
+    uint64_t *degrees[2];
+    for (int side = 0; side < 2; ++side) {
+        degrees[side] = (uint64_t *)xmalloc((V > 0 ? V : 1) * sizeof(uint64_t));
+        for (int v = 0; v < V; ++v) {
+            uint64_t out = (uint64_t)(m->graph[side]->offsets[v + 1] - m->graph[side]->offsets[v]);
+            uint64_t in = (uint64_t)(m->reverse[side]->offsets[v + 1] - m->reverse[side]->offsets[v]);
+            degrees[side][v] = out << 32 | in;
+        }
+    }
+    bool possible = sameMultiset(degrees[0], degrees[1], V);
+    free(degrees[0]);
+    free(degrees[1]);
+    if (!possible) {
+        return false;
+    }
+    for (int side = 0; side < 2; ++side) {
+        m->color[side] = (uint64_t *)xmalloc((V > 0 ? V : 1) * sizeof(uint64_t));
+        refineColors(m->graph[side], m->reverse[side], m->color[side]);
+    }
+    if (!sameMultiset(m->color[0], m->color[1], V)) {
+        return false;
+    }
+
+    m->order = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    m->anchor = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+    m->anchorOut = (bool *)xmalloc((V > 0 ? V : 1) * sizeof(bool));
+    matchingOrder(m);
+
+    // A bit matrix keeps one bit per pair, so it would count parallel edges once on the graph 2
+    // side while matchedTwins counts every arc of graph 1
+    m->dense = useBitMatrix(graph1) && !hasParallelEdges(m->graph[0]) && !hasParallelEdges(m->graph[1]);
+    for (int side = 0; side < 2 && m->dense; ++side) {
+        initBitMatrix(&m->bits[side], m->graph[side], false);
+        if (m->reverse[side] != m->graph[side]) {
+            initBitMatrix(&m->reverseBits[side], m->reverse[side], false);
+        }
+    }
+    return true;
+}
+
+GRAPH_API void freeIsoMatcher(IsoMatcher *m) {
+    for (int side = 0; side < 2; ++side) {
+        if (m->reverse[side] != NULL && m->reverse[side] != m->graph[side]) {
+            freeGraph((Graph *)m->reverse[side]);
+        }
+        free(m->color[side]);
+        if (m->dense) {
+            freeBitMatrix(&m->bits[side]);
+            if (m->reverse[side] != m->graph[side]) {
+                freeBitMatrix(&m->reverseBits[side]);
+            }
+        }
+    }
+    free(m->order);
+    free(m->anchor);
+    free(m->anchorOut);
+}
+
+GRAPH_API void initIsoState(IsoState *st, const IsoMatcher *m) {
+    int V = m->V;
+    for (int side = 0; side < 2; ++side) {
+        st->core[side] = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+        st->touching[side] = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+        for (int v = 0; v < V; ++v) {
+            st->core[side][v] = -1;
+            st->touching[side][v] = 0;
+        }
+        st->matched[side] = m->dense ? newBits(m->bits[side].words) : NULL;
+    }
+}
+
+GRAPH_API void freeIsoState(IsoState *st) {
+    for (int side = 0; side < 2; ++side) {
+        free(st->core[side]);
+        free(st->touching[side]);
+        free(st->matched[side]);
+    }
+}
+
+// Function to test the edge u -> v of one graph
+GRAPH_API bool isoEdge(const IsoMatcher *m, int side, int u, int v) {
+    return m->dense ? hasBitEdge(&m->bits[side], u, v) : findEdge(m->graph[side], u, v) >= 0;
+}
+
+// Function to add (delta = 1) or remove (delta = -1) vertex v of one graph from the matched part
+GRAPH_API void updateTouching(const IsoMatcher *m, IsoState *st, int side, int v, int delta) {
+    const Graph *g = m->graph[side];
+    for (int64_t e = g->offsets[v]; e < g->offsets[v + 1]; ++e) {
+        st->touching[side][g->dest[e]] += delta;
+    }
+    if (m->reverse[side] != g) {
+        const Graph *r = m->reverse[side];
+        for (int64_t e = r->offsets[v]; e < r->offsets[v + 1]; ++e) {
+            st->touching[side][r->dest[e]] += delta;
+        }
+    }
+}
+
+GRAPH_API void assignPair(const IsoMatcher *m, IsoState *st, int u, int v) {
+    st->core[0][u] = v;
+    st->core[1][v] = u;
+    updateTouching(m, st, 0, u, 1);
+    updateTouching(m, st, 1, v, 1);
+    if (m->dense) {
+        setBit(st->matched[0], u);
+        setBit(st->matched[1], v);
+    }
+}
+
+GRAPH_API void unassignPair(const IsoMatcher *m, IsoState *st, int u) {
+    int v = st->core[0][u];
+    st->core[0][u] = -1;
+    st->core[1][v] = -1;
+    updateTouching(m, st, 0, u, -1);
+    updateTouching(m, st, 1, v, -1);
+    if (m->dense) {
+        clearBit(st->matched[0], u);
+        clearBit(st->matched[1], v);
+    }
+}
+
+// Function to count the matched neighbours of u in graph 1 along one direction (out-edges
+// for direction 0), or -1 when one of them has no twin next to v in graph 2
+GRAPH_API int matchedTwins(const IsoMatcher *m, const IsoState *st, int u, int v, int direction) {
+    const Graph *g = direction == 0 ? m->graph[0] : m->reverse[0];
+    int count = 0;
+    for (int64_t e = g->offsets[u]; e < g->offsets[u + 1]; ++e) {
+        int w = g->dest[e];
+        if (st->core[0][w] < 0 || w == u) {
+            continue;
+        }
+        if (!isoEdge(m, 1, direction == 0 ? v : st->core[0][w], direction == 0 ? st->core[0][w] : v)) {
+            return -1; // The edge has no image
+        }
+        count++;
+    }
+    return count;
+}
+
+// Function to count the matched neighbours of v in graph 2 along one direction; v itself is
+// never matched yet, so a self-loop does not count
+GRAPH_API int matchedCount(const IsoMatcher *m, const IsoState *st, int v, int direction) {
+    if (m->dense) {
+        const BitMatrix *bits = direction == 0 || m->reverse[1] == m->graph[1] ? &m->bits[1] : &m->reverseBits[1];
+        return (int)andCountBits(bitRow(bits, v), st->matched[1], bits->words);
+    }
+    const Graph *g = direction == 0 ? m->graph[1] : m->reverse[1];
+    int count = 0;
+    for (int64_t e = g->offsets[v]; e < g->offsets[v + 1]; ++e) {
+        count += st->core[1][g->dest[e]] >= 0;
+    }
+    return count;
+}
+
+// Function to sum up the unmatched neighbours of v: how many touch the matched part and how
+// many do not, with a checksum of their colors and touch counts for each group
+GRAPH_API void frontierProfile(const Graph *g, int v, const IsoState *st, int side, const uint64_t *color, uint64_t profile[4]) {
+    profile[0] = profile[1] = profile[2] = profile[3] = 0;
+    for (int64_t e = g->offsets[v]; e < g->offsets[v + 1]; ++e) {
+        int w = g->dest[e];
+        if (st->core[side][w] >= 0 || w == v) {
+            continue;
+        }
+        int group = st->touching[side][w] > 0 ? 0 : 2;
+        profile[group]++;
+        profile[group + 1] += hashCombine(color[w], (uint64_t)st->touching[side][w]);
+    }
+}
+
+// Function to check that matching u to v keeps every edge between u and the matched part, and
+// that the unmatched neighbourhoods of u and v still look alike (the VF2++ lookahead)
+GRAPH_API bool feasiblePair(const IsoMatcher *m, const IsoState *st, int u, int v) {
+    if (m->color[0][u] != m->color[1][v]) {
+        return false;
+    }
+    if (isoEdge(m, 0, u, u) != isoEdge(m, 1, v, v)) {
+        return false;
+    }
+    bool symmetric = m->reverse[0] == m->graph[0];
+    for (int direction = 0; direction < (symmetric ? 1 : 2); ++direction) {
+        // Each matched u -> w needs v -> core(w) (in-edges: w -> u needs core(w) -> v),
+        // and v may have no extra matched neighbours
+        const Graph *g0 = direction == 0 ? m->graph[0] : m->reverse[0];
+        const Graph *g1 = direction == 0 ? m->graph[1] : m->reverse[1];
+        int count = matchedTwins(m, st, u, v, direction);
+        if (count < 0 || count != matchedCount(m, st, v, direction)) {
+            return false;
+        }
+        uint64_t profile0[4], profile1[4];
+        frontierProfile(g0, u, st, 0, m->color[0], profile0);
+        frontierProfile(g1, v, st, 1, m->color[1], profile1);
+        if (memcmp(profile0, profile1, sizeof(profile0)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to list the candidates of the vertex at a depth: images must be adjacent to the
+// anchor's image, or any vertex of graph 2 when there is no anchor (g is then NULL)
+GRAPH_API void candidateRange(const IsoMatcher *m, const IsoState *st, int depth, const Graph **g, int64_t *begin, int64_t *end) {
+    int u = m->order[depth];
+    int a = m->anchor[u];
+    *g = NULL;
+    *begin = 0;
+    *end = m->V;
+    if (a >= 0) {
+        *g = m->anchorOut[u] ? m->reverse[1] : m->graph[1];
+        *begin = (*g)->offsets[st->core[0][a]];
+        *end = (*g)->offsets[st->core[0][a] + 1];
+    }
+}
+
+// Function to extend the matching from depth 'first' with an explicit stack (depth can reach V);
+// true once every vertex is matched, false when every extension failed or *stop was raised
+GRAPH_API bool matchFrom(const IsoMatcher *m, IsoState *st, int first, int64_t *states, atomic_bool *stop) {
+    int V = m->V;
+    int64_t *cursor = (int64_t *)xmalloc((V + 1) * sizeof(int64_t));
+    const Graph *g;
+    int64_t begin, end;
+    int depth = first;
+    bool found = false;
+    int64_t steps = 0;
+    if (depth < V) {
+        candidateRange(m, st, depth, &g, &cursor[depth], &end);
+    }
+
+    while (depth >= first) {
+        if (depth == V) {
+            found = true;
+            break;
+        }
+        if (stop != NULL && (++steps & 1023) == 0 && atomic_load_explicit(stop, memory_order_relaxed)) {
+            break; // Another worker finished the search
+        }
+        int u = m->order[depth];
+        candidateRange(m, st, depth, &g, &begin, &end);
+        int64_t i = cursor[depth];
+        while (i < end) {
+            int v = g != NULL ? g->dest[i] : (int)i;
+            if (st->core[1][v] < 0 && feasiblePair(m, st, u, v)) {
+                break;
+            }
+            i++;
+        }
+        cursor[depth] = i;
+        if (i < end) {
+            // Descend with u -> v
+            (*states)++;
+            assignPair(m, st, u, g != NULL ? g->dest[i] : (int)i);
+            depth++;
+            if (depth < V) {
+                candidateRange(m, st, depth, &g, &cursor[depth], &end);
+            }
+            continue;
+        }
+        // Exhausted: undo the previous depth and try its next candidate
+        depth--;
+        if (depth >= first) {
+            unassignPair(m, st, m->order[depth]);
+            cursor[depth]++;
+        }
+    }
+
+    free(cursor);
+    return found;
+}
+
+// Function to find an isomorphism from graph1 to graph2; mapping[u] receives the image of u
+GRAPH_API bool findIsomorphism(const Graph *graph1, const Graph *graph2, int *mapping, int64_t *states) {
+    IsoMatcher m;
+    IsoState st;
+    bool found = false;
+    if (prepareIso(&m, graph1, graph2)) {
+        initIsoState(&st, &m);
+        found = matchFrom(&m, &st, 0, &m.states, NULL);
+        if (found) {
+            memcpy(mapping, st.core[0], m.V * sizeof(int));
+        }
+        freeIsoState(&st);
+    }
+    if (states != NULL) {
+        *states = m.states;
+    }
+    statAdd(STAT_SEARCH_NODES, m.states);
+    freeIsoMatcher(&m);
+    return found;
+}
+
+#endif // ISO_H
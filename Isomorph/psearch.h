@@ -0,0 +1,144 @@
+/**
+ * @file psearch.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Parallel isomorphism search: top-level branches as tasks on a work-stealing scheduler.
+ * @version 0.1
+ * @date 2023-10-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * The feasible assignments of the first one to three vertices of the matching order are
+ * listed as tasks, going one level deeper while there are fewer than 8 tasks per thread.
+ * Each worker replays a task's prefix on its own search state and runs the
+ * sequential matcher below it. The first worker that completes a mapping raises a shared
+ * flag; the others see it within 1024 steps and return, so no thread is cancelled mid-way.
+ */
+#ifndef PSEARCH_H
+#define PSEARCH_H
+
+#include "../Common/parallel.h"
+#include "iso.h"
+
+#define ISO_MAX_PREFIX 3
+#define ISO_TASKS_PER_THREAD 8
+
+typedef struct ParallelIso {
+    const IsoMatcher *m;
+    int depth;                 // Prefix length of every task
+    int *prefixes;             // Images of order[0 .. depth - 1], depth ints per task
+    int64_t tasks;
+    int64_t capacity;
+    WorkStealing ws;
+    atomic_bool found;
+    atomic_llong states;
+    int *mapping;
+} ParallelIso;
+
+// Function to list every feasible prefix of the given length
+GRAPH_API void listPrefixes(ParallelIso *run, IsoState *st, int depth, int *images) {
+    const IsoMatcher *m = run->m;
+    if (depth == run->depth) {
+        if (run->tasks == run->capacity) {
+            run->capacity = run->capacity ? run->capacity * 2 : 64;
+            run->prefixes = (int *)xrealloc(run->prefixes, run->capacity * run->depth * sizeof(int));
+        }
+        memcpy(run->prefixes + run->tasks * run->depth, images, run->depth * sizeof(int));
+        run->tasks++;
+        return;
+    }
+    const Graph *g;
+    int64_t begin, end;
+    int u = m->order[depth];
+    candidateRange(m, st, depth, &g, &begin, &end);
+    for (int64_t i = begin; i < end; ++i) {
+        int v = g != NULL ? g->dest[i] : (int)i;
+        if (st->core[1][v] >= 0 || !feasiblePair(m, st, u, v)) {
+            continue;
+        }
+        assignPair(m, st, u, v);
+        images[depth] = v;
+        listPrefixes(run, st, depth + 1, images);
+        unassignPair(m, st, u);
+    }
+}
+
+GRAPH_API void isoWorker(void *context, int thread, int threads) {
+    (void)threads;
+    ParallelIso *run = (ParallelIso *)context;
+    const IsoMatcher *m = run->m;
+    IsoState st;
+    initIsoState(&st, m);
+    int64_t states = 0;
+    int64_t task;
+    while (!atomic_load(&run->found) && takeTask(&run->ws, thread, &task)) {
+        const int *images = run->prefixes + task * run->depth;
+        for (int d = 0; d < run->depth; ++d) {
+            assignPair(m, &st, m->order[d], images[d]);
+        }
+        states += run->depth;
+        if (matchFrom(m, &st, run->depth, &states, &run->found)) {
+            bool expected = false;
+            if (atomic_compare_exchange_strong(&run->found, &expected, true)) {
+                memcpy(run->mapping, st.core[0], m->V * sizeof(int)); // Only the first finisher writes
+            }
+            break;
+        }
+        for (int d = run->depth - 1; d >= 0; --d) {
+            unassignPair(m, &st, m->order[d]);
+        }
+    }
+    atomic_fetch_add(&run->states, states);
+    statAdd(STAT_SEARCH_NODES, states);
+    freeIsoState(&st);
+}
+
+// Function to find an isomorphism with the given number of threads
+GRAPH_API bool findIsomorphismParallel(const Graph *graph1, const Graph *graph2, int *mapping, int threads, int64_t *states) {
+    IsoMatcher m;
+    bool found = false;
+    if (states != NULL) {
+        *states = 0;
+    }
+    if (!prepareIso(&m, graph1, graph2)) {
+        freeIsoMatcher(&m);
+        return false;
+    }
+    if (m.V == 0) {
+        freeIsoMatcher(&m);
+        return true;
+    }
+
+    ParallelIso run;
+    run.m = &m;
+    run.prefixes = NULL;
+    run.mapping = mapping;
+    atomic_init(&run.found, false);
+    atomic_init(&run.states, 0);
+    int images[ISO_MAX_PREFIX];
+    IsoState st;
+    initIsoState(&st, &m);
+    for (run.depth = 1;; run.depth++) {
+        run.tasks = 0;
+        run.capacity = 0;
+        free(run.prefixes);
+        run.prefixes = NULL;
+        listPrefixes(&run, &st, 0, images);
+        if (run.tasks >= (int64_t)threads * ISO_TASKS_PER_THREAD || run.depth == ISO_MAX_PREFIX || run.depth == m.V) {
+            break;
+        }
+    }
+    freeIsoState(&st);
+
+    initWorkStealing(&run.ws, run.tasks, threads);
+    parallelRun(threads, isoWorker, &run);
+    freeWorkStealing(&run.ws);
+    found = atomic_load(&run.found);
+    if (states != NULL) {
+        *states = atomic_load(&run.states);
+    }
+    free(run.prefixes);
+    freeIsoMatcher(&m);
+    return found;
+}
+
+#endif // PSEARCH_H
@@ -0,0 +1,208 @@
+/**
+ * @file boruvka.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Parallel Boruvka minimum spanning forest on a concurrent union-find.
+ * @version 0.1
+ * @date 2023-10-16
+ * @copyright Copyright (c) 2023
+ *
+ * Each round, every thread scans its block of vertices and offers each edge that leaves a
+ * component to that component's best-edge slot with a compare-and-swap minimum. The chosen
+ * edges are then merged in parallel; with the (weight, smaller endpoint, larger endpoint)
+ * order of mst.h the chosen edges never close a cycle, and an edge picked from both sides
+ * is merged only once. Rounds repeat until no component has an outgoing edge, at most
+ * log2(V) of them. The forest is finally rooted like primForest roots it, so both engines
+ * print the same result.
+ */
+#ifndef BORUVKA_H
+#define BORUVKA_H
+
+#include "../Common/parallel.h"
+#include "../Common/unionfind.h"
+#include "mst.h"
+
+typedef struct BoruvkaRun
+{
+  const Graph *graph;
+  int *source;          // Source vertex of every edge slot
+  int64_t *best;        // Best outgoing edge of each component root, -1 when none
+  UnionFind uf;
+  int64_t *chosen;      // Edges added to the forest
+  atomic_llong chosenCount;
+  atomic_int progress;  // Set when a round found an outgoing edge
+} BoruvkaRun;
+
+// Function to tell whether edge a precedes edge b in the total edge order
+GRAPH_API bool edgeBefore(const BoruvkaRun *run, int64_t a, int64_t b)
+{
+  const Graph *graph = run->graph;
+  if (graph->weight[a] != graph->weight[b])
+  {
+    return graph->weight[a] < graph->weight[b];
+  }
+  return edgeTie(run->source[a], graph->dest[a]) < edgeTie(run->source[b], graph->dest[b]);
+}
+
+GRAPH_API void boruvkaSources(void *context, int thread, int threads)
+{
+  BoruvkaRun *run = (BoruvkaRun *)context;
+  int64_t begin, end;
+  parallelBlock(run->graph->V, thread, threads, &begin, &end);
+  for (int64_t u = begin; u < end; u++)
+  {
+    for (int64_t e = run->graph->offsets[u]; e < run->graph->offsets[u + 1]; e++)
+    {
+      run->source[e] = (int)u;
+    }
+  }
+}
+
+// Phase 1: offer every edge between two components to the best slot of its source component
+GRAPH_API void boruvkaSelect(void *context, int thread, int threads)
+{
+  BoruvkaRun *run = (BoruvkaRun *)context;
+  const Graph *graph = run->graph;
+  int64_t begin, end;
+  parallelBlock(graph->V, thread, threads, &begin, &end);
+  bool found = false;
+  int64_t scanned = 0;
+  for (int64_t u = begin; u < end; u++)
+  {
+    int root = ufFind(&run->uf, (int)u);
+    STAT_ADD(scanned, graph->offsets[u + 1] - graph->offsets[u]);
+    for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+    {
+      if (ufFind(&run->uf, graph->dest[e]) == root)
+      {
+        continue;
+      }
+      found = true;
+      int64_t current = __atomic_load_n(&run->best[root], __ATOMIC_RELAXED);
+      while (current < 0 || edgeBefore(run, e, current))
+      {
+        if (__atomic_compare_exchange_n(&run->best[root], &current, e, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+          break;
+        }
+      }
+    }
+  }
+  if (found)
+  {
+    atomic_store(&run->progress, 1);
+  }
+  statAdd(STAT_EDGES_SCANNED, scanned);
+}
+
+// Phase 2: merge along the best edge of every component and clear the slots for the next round
+GRAPH_API void boruvkaMerge(void *context, int thread, int threads)
+{
+  BoruvkaRun *run = (BoruvkaRun *)context;
+  int64_t begin, end;
+  parallelBlock(run->graph->V, thread, threads, &begin, &end);
+  for (int64_t c = begin; c < end; c++)
+  {
+    int64_t e = run->best[c];
+    if (e < 0)
+    {
+      continue;
+    }
+    run->best[c] = -1;
+    if (ufUnion(&run->uf, run->source[e], run->graph->dest[e]))
+    {
+      run->chosen[atomic_fetch_add(&run->chosenCount, 1)] = e;
+    }
+  }
+}
+
+// Function to give the chosen edges parents, rooting each tree where primForest would
+GRAPH_API void rootForest(const BoruvkaRun *run, int start, SpanningForest *forest)
+{
+  const Graph *graph = run->graph;
+  int V = graph->V;
+  int64_t count = atomic_load(&run->chosenCount);
+  GraphBuilder builder;
+  initGraphBuilder(&builder, V);
+  for (int64_t i = 0; i < count; i++)
+  {
+    int64_t e = run->chosen[i];
+    addEdge(&builder, run->source[e], graph->dest[e], graph->weight[e]);
+    addEdge(&builder, graph->dest[e], run->source[e], graph->weight[e]);
+  }
+  Graph *tree = buildGraph(&builder, NULL);
+
+  bool *visited = (bool *)xmalloc(V * sizeof(bool));
+  int *queue = (int *)xmalloc((V > 0 ? V : 1) * sizeof(int));
+  for (int v = 0; v < V; v++)
+  {
+    visited[v] = false;
+  }
+  for (int i = 0; i < V; i++)
+  {
+    int root = (start + i) % V;
+    if (visited[root])
+    {
+      continue;
+    }
+    forest->trees++;
+    visited[root] = true;
+    int head = 0, tail = 0;
+    queue[tail++] = root;
+    while (head < tail)
+    {
+      int u = queue[head++];
+      for (int64_t e = tree->offsets[u]; e < tree->offsets[u + 1]; e++)
+      {
+        int v = tree->dest[e];
+        if (!visited[v])
+        {
+          visited[v] = true;
+          forest->parent[v] = u;
+          forest->weight[v] = tree->weight[e];
+          forest->edges++;
+          forest->totalWeight += tree->weight[e];
+          queue[tail++] = v;
+        }
+      }
+    }
+  }
+
+  free(queue);
+  free(visited);
+  freeGraph(tree);
+}
+
+// Function to find a minimum spanning forest with parallel Boruvka; the graph must be symmetric
+GRAPH_API void boruvkaForest(const Graph *graph, int start, int threads, SpanningForest *forest)
+{
+  int V = graph->V;
+  BoruvkaRun run;
+  run.graph = graph;
+  run.source = (int *)xmalloc((graph->E > 0 ? graph->E : 1) * sizeof(int));
+  run.best = (int64_t *)xmalloc((V > 0 ? V : 1) * sizeof(int64_t));
+  run.chosen = (int64_t *)xmalloc((V > 0 ? V : 1) * sizeof(int64_t));
+  atomic_init(&run.chosenCount, 0);
+  initUnionFind(&run.uf, V);
+  for (int v = 0; v < V; v++)
+  {
+    run.best[v] = -1;
+  }
+  parallelRun(threads, boruvkaSources, &run);
+
+  do
+  {
+    atomic_store(&run.progress, 0);
+    parallelRun(threads, boruvkaSelect, &run);
+    parallelRun(threads, boruvkaMerge, &run);
+  } while (atomic_load(&run.progress));
+
+  initForest(forest, V);
+  rootForest(&run, start, forest);
+
+  freeUnionFind(&run.uf);
+  free(run.chosen);
+  free(run.best);
+  free(run.source);
+}
+
+#endif // BORUVKA_H
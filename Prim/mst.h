@@ -0,0 +1,161 @@
+/**
+ * @file mst.h
+ * @author Jorge Ricarte (jorgericartepg@gmail.com)
+ * @brief Minimum spanning forest with Prim's algorithm on an indexed heap.
+ * @version 0.1
+ * @date 2023-10-16
+ * @copyright Copyright (c) 2023
+ *
+ * The graph must be symmetric (see undirectedGraph in graph.h for directed inputs). Prim grows
+ * one tree from the start vertex, then a new tree from every vertex still outside the
+ * forest, so each component gets its own tree. Edges are ordered by weight, then by the
+ * smaller endpoint, then by the larger one; with that total order the minimum spanning
+ * forest is unique, so every MST engine returns the same edge set.
+ */
+#ifndef MST_H
+#define MST_H
+
+#include "../Common/graph.h"
+#include "../Common/heap.h"
+
+// Result of a run: parent[v] is -1 for the root of each tree
+typedef struct SpanningForest
+{
+  int V;
+  int *parent;
+  int *weight;          // Weight of the edge parent[v] - v
+  int edges;
+  int trees;
+  int64_t totalWeight;
+} SpanningForest;
+
+GRAPH_API void initForest(SpanningForest *forest, int V)
+{
+  forest->V = V;
+  forest->parent = (int *)xmalloc(V * sizeof(int));
+  forest->weight = (int *)xmalloc(V * sizeof(int));
+  forest->edges = 0;
+  forest->trees = 0;
+  forest->totalWeight = 0;
+  for (int v = 0; v < V; v++)
+  {
+    forest->parent[v] = -1;
+    forest->weight[v] = 0;
+  }
+}
+
+GRAPH_API void freeForest(SpanningForest *forest)
+{
+  free(forest->parent);
+  free(forest->weight);
+}
+
+// Function to pack the endpoints of an edge as its tie-break key
+GRAPH_API int64_t edgeTie(int u, int v)
+{
+  return u < v ? ((int64_t)u << 32) | (uint32_t)v : ((int64_t)v << 32) | (uint32_t)u;
+}
+
+// Function to find a minimum spanning forest with Prim's algorithm, starting from 'start'
+GRAPH_API void primForest(const Graph *graph, int start, SpanningForest *forest)
+{
+  int V = graph->V;
+  bool *inMST = (bool *)xmalloc(V * sizeof(bool));
+  IndexedHeap heap;
+  initHeap(&heap, V);
+  enableHeapTies(&heap);
+  initForest(forest, V);
+  for (int v = 0; v < V; v++)
+  {
+    inMST[v] = false;
+  }
+
+  int64_t scanned = 0, relaxed = 0;
+  for (int i = 0; i < V; i++)
+  {
+    int root = (start + i) % V;
+    if (inMST[root])
+    {
+      continue;
+    }
+    forest->trees++;
+    heapPushOrDecreaseTie(&heap, root, 0, -1);
+
+    while (!heapEmpty(&heap))
+    {
+      int u = heapPop(&heap);
+      inMST[u] = true;
+      STAT_ADD(scanned, graph->offsets[u + 1] - graph->offsets[u]);
+      if (forest->parent[u] >= 0)
+      {
+        forest->edges++;
+        forest->totalWeight += forest->weight[u];
+      }
+
+      for (int64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++)
+      {
+        int v = graph->dest[e];
+        if (!inMST[v] && heapPushOrDecreaseTie(&heap, v, graph->weight[e], edgeTie(u, v)))
+        {
+          forest->parent[v] = u;
+          forest->weight[v] = graph->weight[e];
+          STAT_INC(relaxed);
+        }
+      }
+    }
+  }
+
+  statAdd(STAT_VERTICES_SETTLED, V);
+  statAdd(STAT_EDGES_SCANNED, scanned);
+  statAdd(STAT_EDGES_RELAXED, relaxed);
+  publishHeapStats(&heap);
+  freeHeap(&heap);
+  free(inMST);
+}
+
+// Function to print the edges of the forest, one line (text) or row (CSV) per vertex that has a
+// parent; binary output is the parent array then the weight array, int32 each (roots have parent
+// -1 and weight 0)
+GRAPH_API void printForest(const Graph *graph, const SpanningForest *forest, const char *engine)
+{
+  OutputFormat format = outputFormat();
+  if (format == OUTPUT_BINARY)
+  {
+    outputBytes(forest->parent, graph->V * sizeof(int));
+    outputBytes(forest->weight, graph->V * sizeof(int));
+    outputFlush();
+    return;
+  }
+  if (format == OUTPUT_CSV)
+  {
+    outputText("parent,vertex,weight\n");
+  }
+  else
+  {
+    printf("Minimum Spanning Forest found by %s algorithm:\n", engine);
+  }
+  for (int i = 0; i < graph->V; i++)
+  {
+    if (forest->parent[i] < 0)
+    {
+      continue;
+    }
+    if (format == OUTPUT_TEXT)
+    {
+      outputText("Edge: ");
+    }
+    outputVertex(graph, forest->parent[i]);
+    outputText(format == OUTPUT_CSV ? "," : " - ");
+    outputVertex(graph, i);
+    outputText(format == OUTPUT_CSV ? "," : ", Weight: ");
+    outputInt(forest->weight[i]);
+    outputChar('\n');
+  }
+  outputFlush();
+  if (format == OUTPUT_TEXT)
+  {
+    printf("Total weight: %lld (%d edges, %d trees)\n", (long long)forest->totalWeight, forest->edges, forest->trees);
+  }
+}
+
+#endif // MST_H
@@ -1,8 +1,8 @@
 /**
  * @file prim.c
  * @author Jorge Ricarte (jorgericartepg@gmail.com)
- * @brief This code is an implementation of Prim's algorithm to find the Minimum Spanning Tree (MST) of a weighted graph.
- * @version 0.1
+ * @brief This code is an implementation of Prim's algorithm to find the Minimum Spanning Forest of a weighted graph.
+ * @version 0.3
  * @date 2023-10-16
  * 
  * @copyright Copyright (c) 2023
@@ -13,204 +13,148 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
-#include <limits.h>
 
-// Define structures for the graph representation
-typedef struct AdjListNode
-{
-  int dest;
-  int weight;
-  struct AdjListNode *next;
-} AdjListNode;
-
-typedef struct AdjList
-{
-  AdjListNode *head;
-} AdjList;
-
-typedef struct Graph
-{
-  int V;
-  char *labels;
-  bool *inMST; // Novo campo para controle de árvore geradora mínima
-  AdjList *array;
-} Graph;
-
-// Function to create a new adjacency list node
-AdjListNode *newAdjListNode(int dest, int weight)
-{
-  AdjListNode *newNode = (AdjListNode *)malloc(sizeof(AdjListNode));
-  newNode->dest = dest;
-  newNode->weight = weight;
-  newNode->next = NULL;
-  return newNode;
-}
+#include "../Common/loader.h"
+#include "boruvka.h"
+#include "mst.h"
 
-// Function to add an edge to the graph
-void addEdge(Graph *graph, int src, int dest, int weight)
+void usage(char *program)
 {
-  AdjListNode *newNode = newAdjListNode(dest, weight);
-  newNode->next = graph->array[src].head;
-  graph->array[src].head = newNode;
+  printf("Usage: %s <file1> [start_vertex] [--engine=prim|boruvka] [--threads=N] [--stats[=FILE]]\n", program);
+  printf("       %s <file1> [start_vertex] [--quiet] [--output=text|csv|binary]\n", program);
+  printf("       %s <file1> --bench [--threads=N]\n", program);
+  exit(1);
 }
 
-// Function to create a graph from a file
-Graph *createGraph(char *fileName)
+// Function to check that two forests hold the same edges (both rooted the same way)
+bool sameForest(SpanningForest *a, SpanningForest *b)
 {
-  // Open the input file
-  FILE *file = fopen(fileName, "r");
-  if (file == NULL)
+  if (a->totalWeight != b->totalWeight || a->edges != b->edges)
   {
-    printf("Erro ao abrir o arquivo.\n");
-    exit(1);
+    return false;
   }
-
-  // Read the first line to determine the number of vertices
-  char line[100];
-  fgets(line, sizeof(line), file);
-
-  int V = 0;
-  for (int i = 0; line[i] != '\0'; ++i)
-  {
-    if (line[i] != ' ' && line[i] != '\n')
-    {
-      ++V;
-    }
-  }
-
-  char vertexLabels[V];
-  for (int i = 0, j = 0; line[i] != '\0'; ++i)
+  for (int v = 0; v < a->V; v++)
   {
-    if (line[i] != ' ' && line[i] != '\n')
+    if (a->parent[v] != b->parent[v])
     {
-      vertexLabels[j] = line[i];
-      ++j;
+      return false;
     }
   }
-
-  // Allocate memory for the graph structure
-  Graph *graph = (Graph *)malloc(sizeof(Graph));
-  graph->V = V;
-  graph->labels = (char *)malloc(V * sizeof(char));
-  graph->inMST = (bool *)malloc(V * sizeof(bool)); // Novo campo para controle de árvore geradora mínima
-
-  for (int i = 0; i < V; ++i)
-  {
-    graph->labels[i] = vertexLabels[i];
-    graph->inMST[i] = false; // Inicializa todos os vértices como fora da árvore geradora mínima
-  }
-
-  graph->array = (AdjList *)malloc(V * sizeof(AdjList));
-  for (int i = 0; i < V; ++i)
-  {
-    graph->array[i].head = NULL;
-  }
-
-  // Populate the adjacency matrix from the file
-  for (int i = 0; i < V; ++i)
-  {
-    for (int j = 0; j < V; ++j)
-    {
-      int weight;
-      fscanf(file, "%d", &weight);
-      if (weight > 0)
-      {
-        addEdge(graph, i, j, weight);
-      }
-    }
-  }
-
-  fclose(file);
-
-  return graph;
+  return true;
 }
 
-// Function to find the minimum key value vertex not yet included in MST
-int minKey(int key[], bool inMST[], int V)
+// Function to time Prim and Boruvka on 1, 2, 4, ... threads, checking every result against Prim
+void benchmark(Graph *graph, int maxThreads)
 {
-  int min = INT_MAX, min_index;
-
-  for (int v = 0; v < V; v++)
+  SpanningForest reference, forest;
+  double start = nowSeconds();
+  primForest(graph, 0, &reference);
+  double primTime = nowSeconds() - start;
+  printf("engine\tthreads\tseconds\tspeedup\tmatches\n");
+  printf("prim\t1\t%.3f\t1.00\tyes\n", primTime);
+
+  double base = 0;
+  for (int threads = 1;; threads *= 2)
   {
-    if (!inMST[v] && key[v] < min)
+    threads = threads < maxThreads ? threads : maxThreads;
+    start = nowSeconds();
+    boruvkaForest(graph, 0, threads, &forest);
+    double elapsed = nowSeconds() - start;
+    base = threads == 1 ? elapsed : base;
+    printf("boruvka\t%d\t%.3f\t%.2f\t%s\n", threads, elapsed, base / elapsed, sameForest(&reference, &forest) ? "yes" : "NO");
+    freeForest(&forest);
+    if (threads == maxThreads)
     {
-      min = key[v];
-      min_index = v;
+      break;
     }
   }
-
-  return min_index;
+  freeForest(&reference);
 }
 
-// Function to print the MST
-void printMST(int parent[], int graphSize, int **graph)
+int main(int argc, char *argv[])
 {
-  printf("Edge \tWeight\n");
-  for (int i = 1; i < graphSize; i++)
+  char *file1 = NULL;
+  char *startArg = NULL;
+  bool boruvka = false;
+  bool bench = false;
+  int threads = defaultThreadCount();
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++)
   {
-    printf("%c - %c \t%d\n", graph[parent[i]][i], graph[i][parent[i]], graph[i][parent[i]]);
+    if (strcmp(argv[i], "--engine=prim") == 0)
+      boruvka = false;
+    else if (strcmp(argv[i], "--engine=boruvka") == 0)
+      boruvka = true;
+    else if (strncmp(argv[i], "--threads=", 10) == 0)
+      threads = atoi(argv[i] + 10);
+    else if (strcmp(argv[i], "--bench") == 0)
+      bench = true;
+    else if (strcmp(argv[i], "--quiet") == 0)
+      quiet = true;
+    else if (outputOption(argv[i]))
+      continue;
+    else if (statsOption(argv[i], argv[0]))
+      continue;
+    else if (file1 == NULL)
+      file1 = argv[i];
+    else if (startArg == NULL)
+      startArg = argv[i];
+    else
+      usage(argv[0]);
+  }
+  if (file1 == NULL || threads < 1 || (bench && (startArg != NULL || outputFormat() != OUTPUT_TEXT)))
+  {
+    usage(argv[0]);
   }
-}
-
-// Function to find MST using Prim's algorithm
-void primMST(Graph *graph)
-{
-  int V = graph->V;
-  int parent[V];
-  int key[V];
 
-  for (int i = 0; i < V; i++)
+  Graph *graph1 = createGraph(file1);
+  int start = startArg != NULL && graph1->V > 0 ? findVertex(graph1, startArg) : 0;
+  if (start < 0)
   {
-    key[i] = INT_MAX;
-    parent[i] = -1;
+    printf("Start vertex must be %sbetween 0 and %d.\n", graph1->labels != NULL ? "a vertex name or " : "",
+           graph1->V - 1);
+    return 1;
   }
 
-  key[0] = 0;
+  // A directed input is read as undirected: an edge in either direction joins its endpoints
+  Graph *undirected = isSymmetric(graph1) ? graph1 : undirectedGraph(graph1);
 
-  for (int count = 0; count < V - 1; count++)
+  if (bench)
   {
-    int u = minKey(key, graph->inMST, V);
-    graph->inMST[u] = true;
-
-    for (AdjListNode *v = graph->array[u].head; v; v = v->next)
+    statPhase(PHASE_COMPUTE);
+    benchmark(undirected, threads);
+  }
+  else
+  {
+    statPhase(PHASE_OUTPUT);
+    if (!quiet && outputFormat() == OUTPUT_TEXT)
     {
-      if (!graph->inMST[v->dest] && v->weight < key[v->dest])
-      {
-        parent[v->dest] = u;
-        key[v->dest] = v->weight;
-      }
+      printf("Graph 1:\n");
+      printLabels(graph1);
     }
-  }
 
-  // Print the MST
-  printf("Minimum Spanning Tree (MST) found by Prim's algorithm:\n");
-  for (int i = 1; i < V; i++)
-  {
-    printf("Edge: %c - %c, Weight: %d\n", graph->labels[parent[i]], graph->labels[i], key[i]);
+    SpanningForest forest;
+    statPhase(PHASE_COMPUTE);
+    if (boruvka)
+    {
+      boruvkaForest(undirected, start, threads, &forest);
+    }
+    else
+    {
+      primForest(undirected, start, &forest);
+    }
+    statPhase(PHASE_OUTPUT);
+    printForest(graph1, &forest, boruvka ? "Boruvka's" : "Prim's");
+    freeForest(&forest);
   }
-}
-
-int main(int argc, char *argv[])
-{
-  if (argc != 2)
+  if (undirected != graph1)
   {
-    printf("Usage: %s <file1>\n", argv[0]);
-    return 1;
+    freeGraph(undirected);
   }
 
-  char *file1 = argv[1];
-  Graph *graph1 = createGraph(file1);
-
-  printf("Graph 1:\n");
-  printf("Vertex labels: %s\n", graph1->labels);
-
-  primMST(graph1);
-
   // Free memory
-  free(graph1->labels);
-  free(graph1->inMST);
-  free(graph1->array);
-  free(graph1);
+  freeGraph(graph1);
 
   return 0;
 }
\ No newline at end of file